@@ -4,6 +4,8 @@
 #include "compile_time.h"
 #include "core_types.h"
 
+#define RPVC_MEMORYPOOL_MAX_BLOCK_SIZE 512 // largest size class; bigger requests fail
+
 RPVC_EXTERN_C_BEGIN
 
 RPVC_Status_t RPVC_MEMORYPOOL_Init(void);
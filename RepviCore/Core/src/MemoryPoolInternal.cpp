@@ -4,6 +4,8 @@ namespace RPVC {
     MemoryPool<MemoryPoolManager::MEMPOOL32_BUFFER_SIZE, MemoryPoolManager::MEMPOOL32_BLOCK_SIZE> MemoryPoolManager::memoryPool32_;
     MemoryPool<MemoryPoolManager::MEMPOOL64_BUFFER_SIZE, MemoryPoolManager::MEMPOOL64_BLOCK_SIZE> MemoryPoolManager::memoryPool64_;
     MemoryPool<MemoryPoolManager::MEMPOOL128_BUFFER_SIZE, MemoryPoolManager::MEMPOOL128_BLOCK_SIZE> MemoryPoolManager::memoryPool128_;
+    MemoryPool<MemoryPoolManager::MEMPOOL256_BUFFER_SIZE, MemoryPoolManager::MEMPOOL256_BLOCK_SIZE> MemoryPoolManager::memoryPool256_;
+    MemoryPool<MemoryPoolManager::MEMPOOL512_BUFFER_SIZE, MemoryPoolManager::MEMPOOL512_BLOCK_SIZE> MemoryPoolManager::memoryPool512_;
 
     bool MemoryPoolManager::isInitialized_ = false;
     
@@ -18,6 +20,12 @@ namespace RPVC {
         if (memoryPool128_.Init() != RPVC_OK) {
             return RPVC_ERR_INIT;
         }
+        if (memoryPool256_.Init() != RPVC_OK) {
+            return RPVC_ERR_INIT;
+        }
+        if (memoryPool512_.Init() != RPVC_OK) {
+            return RPVC_ERR_INIT;
+        }
 
         isInitialized_ = true;
         return RPVC_OK;
@@ -39,33 +47,24 @@ namespace RPVC {
 
     void *MemoryPoolManager::AllocateBlock(uint32_t size)
     {
-        if (size <= 32) {
-            void* block;
-            if (memoryPool32_.AllocateBlock(&block) == RPVC_OK) {
-                return block;
-            } else {
-                return nullptr;
-            }
-        }
-        else if (size <= 64) {
-            void* block;
-            if (memoryPool64_.AllocateBlock(&block) == RPVC_OK) {
-                return block;
-            } else {
-                return nullptr;
-            }
-        }
-        else if (size <= 128) {
-            void* block;
-            if (memoryPool128_.AllocateBlock(&block) == RPVC_OK) {
-                return block;
-            } else {
-                return nullptr;
-            }
-        }
-        else {
-            return nullptr; // Size too large
+        // Best-fitting class first; spill into larger classes when it runs dry
+        void* block;
+        if (size <= MEMPOOL32_BLOCK_SIZE && memoryPool32_.AllocateBlock(&block) == RPVC_OK) {
+            return block;
+        }
+        if (size <= MEMPOOL64_BLOCK_SIZE && memoryPool64_.AllocateBlock(&block) == RPVC_OK) {
+            return block;
+        }
+        if (size <= MEMPOOL128_BLOCK_SIZE && memoryPool128_.AllocateBlock(&block) == RPVC_OK) {
+            return block;
         }
+        if (size <= MEMPOOL256_BLOCK_SIZE && memoryPool256_.AllocateBlock(&block) == RPVC_OK) {
+            return block;
+        }
+        if (size <= MEMPOOL512_BLOCK_SIZE && memoryPool512_.AllocateBlock(&block) == RPVC_OK) {
+            return block;
+        }
+        return nullptr; // Size too large or every fitting class exhausted
     }
 
     RPVC_Status_t MemoryPoolManager::FreeBlock(void *ptr)
@@ -79,6 +78,12 @@ namespace RPVC {
         if (memoryPool128_.FreeBlock(ptr) == RPVC_OK) {
             return RPVC_OK;
         }
+        if (memoryPool256_.FreeBlock(ptr) == RPVC_OK) {
+            return RPVC_OK;
+        }
+        if (memoryPool512_.FreeBlock(ptr) == RPVC_OK) {
+            return RPVC_OK;
+        }
         return RPVC_ERR_INVALID_ARG; // Pointer not found in any pool
     }
 };
\ No newline at end of file
@@ -3,18 +3,28 @@
 
 #include "compile_time.h"
 #include "core_types.h"
+#include "RPVC_MEMORYPOOL.h"
+#include "RPVC_CompilerAbstraction.h"
 #include <cstring>
 
 namespace RPVC {
+    // Blocks are tracked in a bitmap claimed by CAS, so threads may allocate
+    // and free concurrently and a scan covers 32 blocks per word.
     template<size_t PoolSize, size_t BlockSize>
     class MemoryPool {
         constexpr static size_t NumBlocks = PoolSize / BlockSize;
+        constexpr static size_t NumWords = (NumBlocks + 31) / 32;
+        static_assert(BlockSize % 8 == 0, "blocks must stay 8-byte aligned for in-place payloads");
         public:
 
         RPVC_Status_t Init() 
         {
             std::memset(pool_, 0, PoolSize);
-            std::memset(allocatedFlags_, 0, sizeof(allocatedFlags_));
+            std::memset(allocatedBits_, 0, sizeof(allocatedBits_));
+            // blocks past NumBlocks in the last word stay permanently taken
+            if (NumBlocks % 32 != 0) {
+                allocatedBits_[NumWords - 1] = ~((1U << (NumBlocks % 32)) - 1U);
+            }
             return RPVC_OK;
         }
 
@@ -25,11 +35,15 @@ namespace RPVC {
 
         RPVC_Status_t AllocateBlock(void **outBlock) 
         {            
-            for (size_t i = 0; i < NumBlocks; ++i) {
-                if (!allocatedFlags_[i]) {
-                    allocatedFlags_[i] = true;
-                    *outBlock = pool_ + (i * BlockSize);
-                    return RPVC_OK;
+            for (size_t word = 0; word < NumWords; ++word) {
+                uint32_t bits = RPVC_ATOMIC_LOAD(&allocatedBits_[word]);
+                while (bits != UINT32_MAX) {
+                    uint32_t bit = RPVC_CTZ32(~bits);
+                    if (RPVC_ATOMIC_CAS(&allocatedBits_[word], bits, bits | (1U << bit))) {
+                        *outBlock = pool_ + ((word * 32 + bit) * BlockSize);
+                        return RPVC_OK;
+                    }
+                    bits = RPVC_ATOMIC_LOAD(&allocatedBits_[word]);
                 }
             }
             return RPVC_ERR_NO_MEMORY; // No free blocks
@@ -43,11 +57,17 @@ namespace RPVC {
             size_t offset = static_cast<uint8_t*>(block) - pool_;
 
             size_t index = offset / BlockSize;
-            if (!allocatedFlags_[index]) {
-                return RPVC_ERR_INVALID_ARG; // Block already free
+            uint32_t *word = &allocatedBits_[index / 32];
+            uint32_t mask = 1U << (index % 32);
+            while (true) {
+                uint32_t bits = RPVC_ATOMIC_LOAD(word);
+                if ((bits & mask) == 0) {
+                    return RPVC_ERR_INVALID_ARG; // Block already free
+                }
+                if (RPVC_ATOMIC_CAS(word, bits, bits & ~mask)) {
+                    return RPVC_OK;
+                }
             }
-            allocatedFlags_[index] = false;
-            return RPVC_OK;
         }
 
         size_t GetBlockSize() const 
@@ -63,8 +83,8 @@ namespace RPVC {
         size_t GetFreeBlockCount() const 
         {
             size_t count = 0;
-            for (size_t i = 0; i < NumBlocks; ++i) {
-                if (!allocatedFlags_[i]) {
+            for (size_t word = 0; word < NumWords; ++word) {
+                for (uint32_t bits = ~RPVC_ATOMIC_LOAD(&allocatedBits_[word]); bits != 0; bits &= bits - 1) {
                     ++count;
                 }
             }
@@ -89,8 +109,8 @@ namespace RPVC {
                    (((static_cast<uint8_t*>(block) - pool_) % BlockSize) == 0);
         }
 
-        uint8_t pool_[PoolSize];
-        bool allocatedFlags_[NumBlocks];
+        alignas(8) uint8_t pool_[PoolSize];
+        uint32_t allocatedBits_[NumWords]; // atomic: bit set while the block is allocated
     };
 
     class MemoryPoolManager {
@@ -106,14 +126,22 @@ namespace RPVC {
         static constexpr int MEMPOOL32_BUFFER_SIZE = 1024 * 5;
         static constexpr int MEMPOOL64_BUFFER_SIZE = 1024 * 10;
         static constexpr int MEMPOOL128_BUFFER_SIZE = 1024 * 20;
+        static constexpr int MEMPOOL256_BUFFER_SIZE = 1024 * 8;
+        static constexpr int MEMPOOL512_BUFFER_SIZE = 1024 * 8;
 
         static constexpr int MEMPOOL32_BLOCK_SIZE = 32;
         static constexpr int MEMPOOL64_BLOCK_SIZE = 64;
         static constexpr int MEMPOOL128_BLOCK_SIZE = 128;
-        
+        static constexpr int MEMPOOL256_BLOCK_SIZE = 256;
+        static constexpr int MEMPOOL512_BLOCK_SIZE = 512;
+        static_assert(MEMPOOL512_BLOCK_SIZE == RPVC_MEMORYPOOL_MAX_BLOCK_SIZE, "largest class must match the public limit");
+
+
         static MemoryPool<MEMPOOL32_BUFFER_SIZE, MEMPOOL32_BLOCK_SIZE> memoryPool32_;
         static MemoryPool<MEMPOOL64_BUFFER_SIZE, MEMPOOL64_BLOCK_SIZE> memoryPool64_;
         static MemoryPool<MEMPOOL128_BUFFER_SIZE, MEMPOOL128_BLOCK_SIZE> memoryPool128_;
+        static MemoryPool<MEMPOOL256_BUFFER_SIZE, MEMPOOL256_BLOCK_SIZE> memoryPool256_;
+        static MemoryPool<MEMPOOL512_BUFFER_SIZE, MEMPOOL512_BLOCK_SIZE> memoryPool512_;
 
         static bool isInitialized_;
     };
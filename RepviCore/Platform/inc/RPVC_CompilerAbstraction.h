@@ -13,6 +13,8 @@
  *   - IAR / Keil / Green Hills / TI / others (with graceful fallbacks)
  */
 
+#include <stdint.h>
+
 /* --------------------------------------------------------------------------
  *  Compiler detection
  * -------------------------------------------------------------------------- */
@@ -99,6 +101,34 @@
     #define RPVC_UNLIKELY(x)    (x)
 #endif
 
+/* --------------------------------------------------------------------------
+ *  Bit scan (x must be non-zero)
+ * -------------------------------------------------------------------------- */
+
+#if defined(RPVC_COMPILER_GCC) || defined(RPVC_COMPILER_CLANG)
+    #define RPVC_CTZ32(x)       ((uint32_t)__builtin_ctz((unsigned int)(x)))
+#elif defined(RPVC_COMPILER_MSVC)
+    #include <intrin.h>
+    static __inline uint32_t RPVC_Ctz32Msvc(uint32_t x)
+    {
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return (uint32_t)index;
+    }
+    #define RPVC_CTZ32(x)       RPVC_Ctz32Msvc((uint32_t)(x))
+#else
+    static inline uint32_t RPVC_Ctz32Generic(uint32_t x)
+    {
+        uint32_t n = 0;
+        while ((x & 1U) == 0U) {
+            x >>= 1;
+            n++;
+        }
+        return n;
+    }
+    #define RPVC_CTZ32(x)       RPVC_Ctz32Generic((uint32_t)(x))
+#endif
+
 /* --------------------------------------------------------------------------
  *  Fallthrough annotation (for switch statements)
  * -------------------------------------------------------------------------- */
@@ -125,4 +155,81 @@
     #define RPVC_RESTRICT
 #endif
 
+/* --------------------------------------------------------------------------
+ *  Thread-local storage (falls back to a plain static: one context only)
+ * -------------------------------------------------------------------------- */
+
+#if defined(RPVC_COMPILER_GCC) || defined(RPVC_COMPILER_CLANG)
+    #define RPVC_THREAD_LOCAL   __thread
+#elif defined(RPVC_COMPILER_MSVC)
+    #define RPVC_THREAD_LOCAL   __declspec(thread)
+#else
+    #define RPVC_THREAD_LOCAL
+#endif
+
+/* --------------------------------------------------------------------------
+ *  Atomic operations (32-bit words)
+ *
+ *  Used by lock-free producer/consumer code (e.g. Software Bus pipes).
+ *  RPVC_ENABLE_ATOMICS is driven by the CMake option of the same name; when
+ *  it is 0 (or the compiler is unknown) the macros degrade to plain accesses,
+ *  which is only safe when every caller runs in the same execution context.
+ *
+ *  RPVC_ATOMIC_LOAD        acquire load
+ *  RPVC_ATOMIC_STORE       release store
+ *  RPVC_ATOMIC_FETCH_ADD   returns the previous value
+ *  RPVC_ATOMIC_FETCH_SUB   returns the previous value
+ *  RPVC_ATOMIC_CAS         returns non-zero if *p was expected and is now desired
+ *  RPVC_ATOMIC_FENCE       full (sequentially consistent) barrier
+ *
+ *  Every operand must be a naturally aligned 32-bit word (uint32_t): the MSVC
+ *  and fallback paths access exactly 4 bytes through a long/uint32_t pointer,
+ *  so narrower fields get their neighbours clobbered and pointers truncated.
+ *  Publish a pointer by writing it plainly and then storing a 32-bit flag.
+ * -------------------------------------------------------------------------- */
+
+#ifndef RPVC_ENABLE_ATOMICS
+    #define RPVC_ENABLE_ATOMICS 1
+#endif
+
+#if RPVC_ENABLE_ATOMICS && (defined(RPVC_COMPILER_GCC) || defined(RPVC_COMPILER_CLANG))
+    #define RPVC_ATOMIC_LOAD(p)             __atomic_load_n((p), __ATOMIC_ACQUIRE)
+    #define RPVC_ATOMIC_STORE(p, v)         __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+    #define RPVC_ATOMIC_FETCH_ADD(p, v)     __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+    #define RPVC_ATOMIC_FETCH_SUB(p, v)     __atomic_fetch_sub((p), (v), __ATOMIC_ACQ_REL)
+    #define RPVC_ATOMIC_CAS(p, e, d)        __sync_bool_compare_and_swap((p), (e), (d))
+    #define RPVC_ATOMIC_FENCE()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif RPVC_ENABLE_ATOMICS && defined(RPVC_COMPILER_MSVC)
+    #include <intrin.h>
+    #define RPVC_ATOMIC_LOAD(p)             (*(volatile uint32_t *)(p))
+    #define RPVC_ATOMIC_STORE(p, v)         ((void)_InterlockedExchange((volatile long *)(p), (long)(v)))
+    #define RPVC_ATOMIC_FETCH_ADD(p, v)     ((uint32_t)_InterlockedExchangeAdd((volatile long *)(p), (long)(v)))
+    #define RPVC_ATOMIC_FETCH_SUB(p, v)     ((uint32_t)_InterlockedExchangeAdd((volatile long *)(p), -(long)(v)))
+    #define RPVC_ATOMIC_CAS(p, e, d)        (_InterlockedCompareExchange((volatile long *)(p), (long)(d), (long)(e)) == (long)(e))
+    #define RPVC_ATOMIC_FENCE()             _mm_mfence()
+#else
+    /* Single-context fallback - no concurrency guarantees */
+    #define RPVC_ATOMIC_LOAD(p)             (*(volatile uint32_t *)(p))
+    #define RPVC_ATOMIC_STORE(p, v)         ((void)(*(p) = (v)))
+    /* Functions rather than expressions, so discarding the result is warning-free */
+    static inline uint32_t RPVC_AtomicFallbackFetchAdd(volatile uint32_t *p, uint32_t v)
+    {
+        uint32_t previous = *p;
+        *p = previous + v;
+        return previous;
+    }
+    static inline int RPVC_AtomicFallbackCas(volatile uint32_t *p, uint32_t e, uint32_t d)
+    {
+        if (*p != e) {
+            return 0;
+        }
+        *p = d;
+        return 1;
+    }
+    #define RPVC_ATOMIC_FETCH_ADD(p, v)     RPVC_AtomicFallbackFetchAdd((p), (uint32_t)(v))
+    #define RPVC_ATOMIC_FETCH_SUB(p, v)     RPVC_AtomicFallbackFetchAdd((p), 0U - (uint32_t)(v))
+    #define RPVC_ATOMIC_CAS(p, e, d)        RPVC_AtomicFallbackCas((p), (uint32_t)(e), (uint32_t)(d))
+    #define RPVC_ATOMIC_FENCE()             ((void)0)
+#endif
+
 #endif /* RPVC_COMPILER_ABSTRACTION_H */
@@ -48,6 +48,11 @@ int RPVC_OS_SemCreate(RPVC_OS_Sem* s, uint32_t initialCount);
 int RPVC_OS_SemWait(RPVC_OS_Sem* s, uint32_t timeoutMs);
 int RPVC_OS_SemSignal(RPVC_OS_Sem* s);
 
+/* Semaphores are opaque, so callers that cannot see the concrete type take one
+ * from the OSAL's static pool. Returns 0 on success, -1 if unsupported or exhausted. */
+int RPVC_OS_SemAlloc(RPVC_OS_Sem** outSem, uint32_t initialCount);
+int RPVC_OS_SemFree(RPVC_OS_Sem* s);
+
 // -----------------------------------------------------------------------------
 // Queue API
 // -----------------------------------------------------------------------------
@@ -259,6 +259,46 @@ int RPVC_OS_SemSignal(RPVC_OS_Sem* s)
     #endif
 }
 
+int RPVC_OS_SemAlloc(RPVC_OS_Sem** outSem, uint32_t initialCount)
+{
+    #ifdef RPVC_OS_DEFAULT_DEFINE
+    if (outSem == NULL) {
+        return -1;  /* Invalid argument */
+    }
+
+    uint32_t prevIntrState = RPVC_INTERRUPTS_SaveState();
+    RPVC_INTERRUPTS_Disable();
+    size_t index = getFreeElement(sem_used, RPVC_OS_MAX_SEMS);
+    RPVC_INTERRUPTS_RestoreState(prevIntrState);
+
+    if (index == (size_t)-1) {
+        return -1;  /* Pool exhausted */
+    }
+
+    sem_pool[index].count = initialCount;
+    *outSem = &sem_pool[index];
+    return 0;
+    #else
+    // define your own code here if needed
+    return -1;
+    #endif
+}
+
+int RPVC_OS_SemFree(RPVC_OS_Sem* s)
+{
+    #ifdef RPVC_OS_DEFAULT_DEFINE
+    if (s < &sem_pool[0] || s >= &sem_pool[RPVC_OS_MAX_SEMS]) {
+        return -1;  /* Not from the pool */
+    }
+
+    sem_used[s - sem_pool] = false;
+    return 0;
+    #else
+    // define your own code here if needed
+    return -1;
+    #endif
+}
+
 /* Queue API - Not supported in baremetal */
 int RPVC_OS_QueueCreate(
     RPVC_OS_Queue* q,
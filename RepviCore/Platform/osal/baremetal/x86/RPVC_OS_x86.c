@@ -82,6 +82,19 @@ int RPVC_OS_SemSignal(RPVC_OS_Sem* s)
     return -1;  /* Not supported */
 }
 
+int RPVC_OS_SemAlloc(RPVC_OS_Sem** outSem, uint32_t initialCount)
+{
+    (void)outSem;
+    (void)initialCount;
+    return -1;  /* Not supported */
+}
+
+int RPVC_OS_SemFree(RPVC_OS_Sem* s)
+{
+    (void)s;
+    return -1;  /* Not supported */
+}
+
 /* Queue API - Not supported in baremetal */
 int RPVC_OS_QueueCreate(
     RPVC_OS_Queue* q,
@@ -87,6 +87,43 @@ int RPVC_OS_SemSignal(RPVC_OS_Sem* s)
     return (xSemaphoreGive(s->handle) == pdTRUE) ? 0 : -1;
 }
 
+#define RPVC_OS_MAX_SEMS 8
+static RPVC_OS_Sem sem_pool[RPVC_OS_MAX_SEMS];
+static bool sem_used[RPVC_OS_MAX_SEMS];
+
+int RPVC_OS_SemAlloc(RPVC_OS_Sem** outSem, uint32_t initialCount)
+{
+    if (!outSem) return -1;
+    taskENTER_CRITICAL();
+    int index = -1;
+    for (int i = 0; i < RPVC_OS_MAX_SEMS; ++i) {
+        if (!sem_used[i]) {
+            sem_used[i] = true;
+            index = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    if (index < 0) return -1;
+
+    if (RPVC_OS_SemCreate(&sem_pool[index], initialCount) != 0) {
+        sem_used[index] = false;
+        return -1;
+    }
+    *outSem = &sem_pool[index];
+    return 0;
+}
+int RPVC_OS_SemFree(RPVC_OS_Sem* s)
+{
+    if (s < &sem_pool[0] || s >= &sem_pool[RPVC_OS_MAX_SEMS]) return -1;
+    if (s->handle) {
+        vSemaphoreDelete(s->handle);
+        s->handle = NULL;
+    }
+    sem_used[s - sem_pool] = false;
+    return 0;
+}
+
 // -----------------------------------------------------------------------------
 // Queue API
 // -----------------------------------------------------------------------------
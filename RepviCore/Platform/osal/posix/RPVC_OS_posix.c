@@ -0,0 +1,466 @@
+/* POSIX host OS abstraction layer (Linux, macOS, WSL) */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+#include "RPVC_OS.h"
+#include "RPVC_TIME.h"
+#include "RPVC_CompilerAbstraction.h"
+
+#if defined(__linux__)
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+    #define RPVC_OS_USE_FUTEX 1
+#else
+    #define RPVC_OS_USE_FUTEX 0
+#endif
+
+#define RPVC_OS_WAIT_FOREVER UINT32_MAX
+
+struct RPVC_OS_Task {
+    pthread_t thread;
+    void (*entry)(void*);
+    void* arg;
+};
+
+struct RPVC_OS_Mutex {
+    pthread_mutex_t mutex;
+};
+
+struct RPVC_OS_Sem {
+    uint32_t count;
+#if RPVC_OS_USE_FUTEX
+    uint32_t waiters;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+};
+
+struct RPVC_OS_Queue {
+    uint8_t *buffer;
+    uint32_t itemSize;
+    uint32_t length;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t count;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+};
+
+#define RPVC_OS_MAX_SEMS 32
+static RPVC_OS_Sem sem_pool[RPVC_OS_MAX_SEMS];
+static uint32_t sem_used[RPVC_OS_MAX_SEMS];
+
+static bool g_RPVC_OS_Initialized = false;
+
+/* Absolute CLOCK_REALTIME deadline for pthread timed waits */
+static void deadlineFromNow(uint32_t timeoutMs, struct timespec *out)
+{
+    clock_gettime(CLOCK_REALTIME, out);
+    out->tv_sec += timeoutMs / 1000U;
+    out->tv_nsec += (long)(timeoutMs % 1000U) * 1000000L;
+    if (out->tv_nsec >= 1000000000L) {
+        out->tv_sec += 1;
+        out->tv_nsec -= 1000000000L;
+    }
+}
+
+RPVC_Status_t RPVC_OS_Init(void)
+{
+    if (g_RPVC_OS_Initialized) {
+        return RPVC_ERR_INIT;
+    }
+
+    memset(sem_used, 0, sizeof(sem_used));
+    g_RPVC_OS_Initialized = true;
+    return RPVC_OK;
+}
+
+// -----------------------------------------------------------------------------
+// Task API
+// -----------------------------------------------------------------------------
+
+static void *taskTrampoline(void *arg)
+{
+    RPVC_OS_Task *task = (RPVC_OS_Task *)arg;
+    task->entry(task->arg);
+    return NULL;
+}
+
+int RPVC_OS_TaskCreate(
+    RPVC_OS_Task* task,
+    void (*entry)(void*),
+    void* arg,
+    const char* name,
+    uint32_t stackSize,
+    uint32_t priority
+)
+{
+    (void)name;
+    (void)priority; /* Host scheduling policy is left to the OS */
+    if (task == NULL || entry == NULL) {
+        return -1;
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (stackSize >= (uint32_t)PTHREAD_STACK_MIN) {
+        pthread_attr_setstacksize(&attr, stackSize);
+    }
+
+    task->entry = entry;
+    task->arg = arg;
+    int r = pthread_create(&task->thread, &attr, taskTrampoline, task);
+    pthread_attr_destroy(&attr);
+    return (r == 0) ? 0 : -1;
+}
+
+void RPVC_OS_TaskYield(void)
+{
+    sched_yield();
+}
+
+RPVC_Status_t RPVC_OS_TaskSleep(uint32_t ms)
+{
+    struct timespec ts;
+    ts.tv_sec = ms / 1000U;
+    ts.tv_nsec = (long)(ms % 1000U) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0) {
+        if (errno != EINTR) {
+            return RPVC_ERR_INTERNAL;
+        }
+    }
+    return RPVC_OK;
+}
+
+// -----------------------------------------------------------------------------
+// Mutex API
+// -----------------------------------------------------------------------------
+
+int RPVC_OS_MutexCreate(RPVC_OS_Mutex* m)
+{
+    if (m == NULL) {
+        return -1;
+    }
+    return (pthread_mutex_init(&m->mutex, NULL) == 0) ? 0 : -1;
+}
+
+int RPVC_OS_MutexLock(RPVC_OS_Mutex* m)
+{
+    if (m == NULL) {
+        return -1;
+    }
+    return (pthread_mutex_lock(&m->mutex) == 0) ? 0 : -1;
+}
+
+int RPVC_OS_MutexUnlock(RPVC_OS_Mutex* m)
+{
+    if (m == NULL) {
+        return -1;
+    }
+    return (pthread_mutex_unlock(&m->mutex) == 0) ? 0 : -1;
+}
+
+// -----------------------------------------------------------------------------
+// Semaphore API
+// -----------------------------------------------------------------------------
+
+#if RPVC_OS_USE_FUTEX
+/* Private futex: waiters and signalers always live in the same process */
+static int futexWait(uint32_t *addr, uint32_t expected, const struct timespec *relTimeout)
+{
+    return (int)syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, relTimeout, NULL, 0);
+}
+
+static int futexWake(uint32_t *addr, int count)
+{
+    return (int)syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+static bool semTryTake(RPVC_OS_Sem* s)
+{
+    uint32_t c = RPVC_ATOMIC_LOAD(&s->count);
+    while (c > 0) {
+        if (RPVC_ATOMIC_CAS(&s->count, c, c - 1)) {
+            return true;
+        }
+        c = RPVC_ATOMIC_LOAD(&s->count);
+    }
+    return false;
+}
+#endif
+
+int RPVC_OS_SemCreate(RPVC_OS_Sem* s, uint32_t initialCount)
+{
+    if (s == NULL) {
+        return -1;
+    }
+
+    s->count = initialCount;
+#if RPVC_OS_USE_FUTEX
+    s->waiters = 0;
+    return 0;
+#else
+    if (pthread_mutex_init(&s->lock, NULL) != 0) {
+        return -1;
+    }
+    return (pthread_cond_init(&s->cond, NULL) == 0) ? 0 : -1;
+#endif
+}
+
+int RPVC_OS_SemWait(RPVC_OS_Sem* s, uint32_t timeoutMs)
+{
+    if (s == NULL) {
+        return -1;
+    }
+
+#if RPVC_OS_USE_FUTEX
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (!semTryTake(s)) {
+        struct timespec rel;
+        struct timespec *relPtr = NULL;
+
+        if (timeoutMs != RPVC_OS_WAIT_FOREVER) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            int64_t elapsedNs = (int64_t)(now.tv_sec - start.tv_sec) * 1000000000LL
+                              + (now.tv_nsec - start.tv_nsec);
+            int64_t remainingNs = (int64_t)timeoutMs * 1000000LL - elapsedNs;
+            if (remainingNs <= 0) {
+                return -1;  /* Timed out */
+            }
+            rel.tv_sec = (time_t)(remainingNs / 1000000000LL);
+            rel.tv_nsec = (long)(remainingNs % 1000000000LL);
+            relPtr = &rel;
+        }
+
+        RPVC_ATOMIC_FETCH_ADD(&s->waiters, 1);
+        RPVC_ATOMIC_FENCE();
+        futexWait(&s->count, 0, relPtr);
+        RPVC_ATOMIC_FETCH_SUB(&s->waiters, 1);
+    }
+    return 0;
+#else
+    int result = 0;
+    pthread_mutex_lock(&s->lock);
+    if (timeoutMs == RPVC_OS_WAIT_FOREVER) {
+        while (s->count == 0) {
+            pthread_cond_wait(&s->cond, &s->lock);
+        }
+    }
+    else {
+        struct timespec deadline;
+        deadlineFromNow(timeoutMs, &deadline);
+        while (s->count == 0 && result == 0) {
+            result = pthread_cond_timedwait(&s->cond, &s->lock, &deadline);
+        }
+    }
+
+    if (s->count > 0) {
+        s->count--;
+        result = 0;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return (result == 0) ? 0 : -1;
+#endif
+}
+
+int RPVC_OS_SemSignal(RPVC_OS_Sem* s)
+{
+    if (s == NULL) {
+        return -1;
+    }
+
+#if RPVC_OS_USE_FUTEX
+    RPVC_ATOMIC_FETCH_ADD(&s->count, 1);
+    RPVC_ATOMIC_FENCE();
+    if (RPVC_ATOMIC_LOAD(&s->waiters) > 0) {
+        futexWake(&s->count, 1);
+    }
+    return 0;
+#else
+    pthread_mutex_lock(&s->lock);
+    s->count++;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+#endif
+}
+
+int RPVC_OS_SemAlloc(RPVC_OS_Sem** outSem, uint32_t initialCount)
+{
+    if (outSem == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < RPVC_OS_MAX_SEMS; ++i) {
+        if (RPVC_ATOMIC_CAS(&sem_used[i], 0U, 1U)) {
+            if (RPVC_OS_SemCreate(&sem_pool[i], initialCount) != 0) {
+                RPVC_ATOMIC_STORE(&sem_used[i], 0U);
+                return -1;
+            }
+            *outSem = &sem_pool[i];
+            return 0;
+        }
+    }
+    return -1;  /* Pool exhausted */
+}
+
+int RPVC_OS_SemFree(RPVC_OS_Sem* s)
+{
+    if (s < &sem_pool[0] || s >= &sem_pool[RPVC_OS_MAX_SEMS]) {
+        return -1;  /* Not from the pool */
+    }
+
+#if !RPVC_OS_USE_FUTEX
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+#endif
+    RPVC_ATOMIC_STORE(&sem_used[s - sem_pool], 0U);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Queue API
+// -----------------------------------------------------------------------------
+
+int RPVC_OS_QueueCreate(
+    RPVC_OS_Queue* q,
+    uint32_t itemSize,
+    uint32_t length
+)
+{
+    if (q == NULL || itemSize == 0 || length == 0) {
+        return -1;
+    }
+
+    q->buffer = (uint8_t *)malloc((size_t)itemSize * length);
+    if (q->buffer == NULL) {
+        return -1;
+    }
+    q->itemSize = itemSize;
+    q->length = length;
+    q->head = 0;
+    q->tail = 0;
+    q->count = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->notEmpty, NULL);
+    pthread_cond_init(&q->notFull, NULL);
+    return 0;
+}
+
+/* Waits on cond until predicate flips; returns 0 if it did, -1 on timeout */
+static int queueWait(RPVC_OS_Queue* q, pthread_cond_t *cond, const uint32_t *counter,
+                     uint32_t blockedValue, uint32_t timeoutMs)
+{
+    if (timeoutMs == RPVC_OS_WAIT_FOREVER) {
+        while (*counter == blockedValue) {
+            pthread_cond_wait(cond, &q->lock);
+        }
+        return 0;
+    }
+
+    struct timespec deadline;
+    deadlineFromNow(timeoutMs, &deadline);
+    while (*counter == blockedValue) {
+        if (pthread_cond_timedwait(cond, &q->lock, &deadline) == ETIMEDOUT) {
+            return (*counter == blockedValue) ? -1 : 0;
+        }
+    }
+    return 0;
+}
+
+int RPVC_OS_QueueSend(
+    RPVC_OS_Queue* q,
+    const void* item,
+    uint32_t timeoutMs
+)
+{
+    if (q == NULL || q->buffer == NULL || item == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&q->lock);
+    if (queueWait(q, &q->notFull, &q->count, q->length, timeoutMs) != 0) {
+        pthread_mutex_unlock(&q->lock);
+        return -1;
+    }
+
+    memcpy(q->buffer + ((size_t)q->tail * q->itemSize), item, q->itemSize);
+    q->tail = (q->tail + 1) % q->length;
+    q->count++;
+    pthread_cond_signal(&q->notEmpty);
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+int RPVC_OS_QueueReceive(
+    RPVC_OS_Queue* q,
+    void* item,
+    uint32_t timeoutMs
+)
+{
+    if (q == NULL || q->buffer == NULL || item == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&q->lock);
+    if (queueWait(q, &q->notEmpty, &q->count, 0, timeoutMs) != 0) {
+        pthread_mutex_unlock(&q->lock);
+        return -1;
+    }
+
+    memcpy(item, q->buffer + ((size_t)q->head * q->itemSize), q->itemSize);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_cond_signal(&q->notFull);
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Time API
+// -----------------------------------------------------------------------------
+RPVC_Status_t RPVC_OS_GetTick(uint32_t *outTick)
+{
+    return RPVC_TIME_GetTick(outTick);
+}
+
+RPVC_Status_t RPVC_OS_GetTimeMicroseconds(uint64_t *outUs)
+{
+    if (outUs == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return RPVC_ERR_INTERNAL;
+    }
+    *outUs = (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+    return RPVC_OK;
+}
+
+// -----------------------------------------------------------------------------
+// Optional OS Hooks
+// -----------------------------------------------------------------------------
+void RPVC_OS_OnIdle(void)
+{
+    sched_yield();
+}
+
+void RPVC_OS_OnTick(void)
+{
+    /* Ticks are driven by the host clock */
+}
@@ -3,12 +3,65 @@
 
 #include "compile_time.h"
 #include "core_types.h"
+#include <stddef.h>
 
-#define RPVC_SB_MAX_PAYLOAD_SIZE 100
-#define RPVC_SB_MAX_QUEUE_DEPTH 5
+#define RPVC_SB_MAX_PAYLOAD_SIZE 480 // largest pool class (512) minus room for the message header
+#define RPVC_SB_MAX_QUEUE_DEPTH 5 // default pipe depth, see RPVC_SB_CreatePipe
+#define RPVC_SB_MAX_PIPE_DEPTH 4096
 #define RPVC_SB_MAX_PIPES 10
 #define RPVC_SB_MAX_SUBSCRIBERS 10
 #define RPVC_SB_MAX_MESSAGE_ID 20
+#define RPVC_SB_MAX_CALLBACKS 4 // push subscribers per message ID
+#define RPVC_SB_MAX_BROADCAST_READERS 16 // cursors per broadcast topic
+#define RPVC_SB_LATENCY_BUCKETS 16 // log2 buckets of the receive-latency histogram
+
+#ifndef RPVC_SB_MAX_CONTENT_MATCHES
+    #define RPVC_SB_MAX_CONTENT_MATCHES 2 // payload field tests per subscription
+#endif
+
+#ifndef RPVC_SB_MAX_FILTERS
+    #define RPVC_SB_MAX_FILTERS 8 // subscriptions with options in effect, over all topics (1..32)
+#endif
+
+#ifndef RPVC_SB_ENABLE_TIMESTAMPS
+    #define RPVC_SB_ENABLE_TIMESTAMPS 0 // 1: stamp messages on publish (one clock read) to histogram receive latency
+#endif
+
+#ifndef RPVC_SB_MAX_SHARDS
+    #define RPVC_SB_MAX_SHARDS 1 // >1: sharded mode for multi-core hosts, see RPVC_SB_BindShard
+#endif
+
+#ifndef RPVC_SB_SHARD_MAILBOX_DEPTH
+    #define RPVC_SB_SHARD_MAILBOX_DEPTH 64 // messages in flight per (source shard, pipe), power of two
+#endif
+
+#ifndef RPVC_SB_LATCH_HANDOFF_DEPTH
+    #define RPVC_SB_LATCH_HANDOFF_DEPTH 8 // latched messages a pipe holds for topics it joined, power of two
+#endif
+
+#ifndef RPVC_SB_PRIORITY_LANES
+    #define RPVC_SB_PRIORITY_LANES 2 // queues per pipe, received most urgent first (1..32)
+#endif
+
+#ifndef RPVC_SB_PRIORITY_LANE_DEPTH
+    #define RPVC_SB_PRIORITY_LANE_DEPTH 4 // inline slots of each lane above RPVC_SB_PRIORITY_NORMAL
+#endif
+
+#ifndef RPVC_SB_MESSAGE_SLAB_SLOTS
+    #if defined(RPVC_OS_POSIX)
+        #define RPVC_SB_MESSAGE_SLAB_SLOTS 64 // cache-line aligned message slots owned by the bus, 0 for none
+    #else
+        #define RPVC_SB_MESSAGE_SLAB_SLOTS 0 // single-core targets share no lines between cores; opt in if needed
+    #endif
+#endif
+
+#ifndef RPVC_SB_MESSAGE_SLAB_SLOT_SIZE
+    #define RPVC_SB_MESSAGE_SLAB_SLOT_SIZE 128 // header plus payload, a multiple of 64; bigger messages use the pool
+#endif
+
+#define RPVC_SB_PRIORITY_NORMAL 0 // lane of the pipe's configured queue
+#define RPVC_SB_WAIT_FOREVER UINT32_MAX // timeout value for blocking receives
+#define RPVC_SB_MAX_TTL_US 0x7FFFFFFFU // deadlines are compared on the 32-bit microsecond clock
 
 typedef uint16_t RPVC_SbSubscriberId_t; // pipe index
 typedef uint16_t RPVC_SbMsgId_t; // routing key
@@ -19,6 +72,80 @@ typedef struct RPVC_SoftwareBusConfig_s {
 
 typedef struct RPVC_SbMsg_t *RPVC_SbMsgHandle_t;
 
+typedef enum {
+    RPVC_SB_OVERFLOW_DROP_NEWEST = 0, // default: a full pipe skips the new message
+    RPVC_SB_OVERFLOW_DROP_OLDEST,     // a full pipe discards its oldest message to make room
+    RPVC_SB_OVERFLOW_REJECT           // a full pipe fails the whole publish
+} RPVC_SbOverflowPolicy_t;
+
+typedef struct {
+    uint32_t depth; // 1..RPVC_SB_MAX_PIPE_DEPTH
+    RPVC_SbOverflowPolicy_t overflowPolicy;
+    RPVC_SbMsgHandle_t *storage; // depth slots of caller memory, or NULL to take them from the memory pool
+} RPVC_SbPipeConfig_t;
+
+// Push delivery: payload is borrowed and only valid until the handler returns
+typedef void (*RPVC_SbCallback_t)(RPVC_SbMsgId_t messageId, const uint8_t *payload, size_t size, void *context);
+
+// Flow control: called in the receiver's context once a full pipe of the topic has room again
+typedef void (*RPVC_SbCreditCallback_t)(RPVC_SbMsgId_t messageId, void *context);
+
+typedef struct {
+    uint32_t depth; // power of two, 1..RPVC_SB_MAX_PIPE_DEPTH
+    RPVC_SbMsgHandle_t *storage; // depth slots of caller memory, or NULL to take them from the memory pool
+} RPVC_SbBroadcastConfig_t;
+
+typedef enum {
+    RPVC_SB_MATCH_EQ,
+    RPVC_SB_MATCH_NE,
+    RPVC_SB_MATCH_LT,
+    RPVC_SB_MATCH_LE,
+    RPVC_SB_MATCH_GT,
+    RPVC_SB_MATCH_GE,
+    RPVC_SB_MATCH_ANY_BITS, // (field & value) != 0
+    RPVC_SB_MATCH_ALL_BITS  // (field & value) == value
+} RPVC_SbMatchOp_t;
+
+// One payload field test: the unsigned field of width bytes (1, 2 or 4, host
+// byte order) at offset, compared with value
+typedef struct {
+    uint16_t offset;
+    uint8_t width;
+    uint8_t op; // RPVC_SbMatchOp_t
+    uint32_t value;
+} RPVC_SbContentMatch_t;
+
+typedef struct {
+    uint16_t decimation;    // deliver every Nth message; 0 or 1 delivers all
+    uint32_t minIntervalUs; // minimum time between deliveries, 0 for no limit
+    const RPVC_SbContentMatch_t *matches; // all must hold; copied on subscribe
+    uint8_t matchCount;                   // up to RPVC_SB_MAX_CONTENT_MATCHES, 0 for none
+} RPVC_SbSubscribeOptions_t;
+
+typedef struct {
+    uint32_t published;     // publish calls carrying this ID
+    uint32_t delivered;     // copies queued on pipes or broadcast rings, callback invocations and latest-value writes
+    uint32_t droppedFull;   // copies lost to a full pipe's overflow policy
+    uint32_t noSubscribers; // publishes that found no subscriber of any kind
+    uint32_t expired;       // queued copies released unread because their deadline passed
+} RPVC_SbTopicStats_t;
+
+typedef struct {
+    uint32_t depth;     // messages queued when the snapshot was taken
+    uint32_t peakDepth; // high-water mark since the pipe was configured
+    uint32_t received;  // messages taken by the receive calls
+    uint32_t dropped;   // see RPVC_SB_GetPipeDropCount
+    uint32_t expired;   // messages the receive calls skipped as expired
+} RPVC_SbPipeStats_t;
+
+typedef struct {
+    RPVC_SbTopicStats_t topics[RPVC_SB_MAX_MESSAGE_ID];
+    RPVC_SbPipeStats_t pipes[RPVC_SB_MAX_PIPES];
+    // receives by publish-to-receive time: bucket 0 is under 1 us, bucket n
+    // covers [2^(n-1), 2^n) us and the last one everything above
+    uint32_t latencyUs[RPVC_SB_LATENCY_BUCKETS];
+} RPVC_SbStats_t;
+
 RPVC_EXTERN_C_BEGIN
 
 /**
@@ -32,17 +159,419 @@ RPVC_Status_t RPVC_SB_Init(const RPVC_SoftwareBusConfig_t* config);
 
 RPVC_Status_t RPVC_SB_Deinit(void);
 
+/**
+ * Give a pipe its own depth, storage and overflow policy. Pipes that are never
+ * configured hold RPVC_SB_MAX_QUEUE_DEPTH messages and drop the newest.
+ *
+ * Pool-backed storage is one memory pool block, so it holds at most
+ * RPVC_MEMORYPOOL_MAX_BLOCK_SIZE / sizeof(RPVC_SbMsgHandle_t) slots; deeper
+ * pipes need caller storage, which must outlive the pipe.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG; RPVC_ERR_STATE if the
+ *         pipe is active (flush it first); memory pool errors.
+ */
+RPVC_Status_t RPVC_SB_CreatePipe(RPVC_SbSubscriberId_t subscriberId, const RPVC_SbPipeConfig_t *config);
+
+/**
+ * Number of messages a pipe has lost to its overflow policy: skipped
+ * (drop-newest), discarded (drop-oldest) or refused (reject).
+ */
+RPVC_Status_t RPVC_SB_GetPipeDropCount(RPVC_SbSubscriberId_t subscriberId, uint32_t *outDropCount);
+
+/**
+ * Linux hosts (RPVC_OS=posix): an eventfd that becomes readable when the pipe
+ * goes from empty to non-empty, for epoll/poll loops. Publishers write it on
+ * that edge only, so a burst costs one syscall. To consume, read the fd to
+ * clear it, then receive until the pipe reports empty. The fd is created on
+ * the first call, non-blocking, and stays owned by the bus until
+ * RPVC_SB_Deinit; call it from the pipe's receiving thread.
+ *
+ * @return RPVC_OK; RPVC_ERR_INVALID_ARG; RPVC_ERR_NO_RESOURCE if eventfd
+ *         fails; RPVC_ERR_CONFIG on builds without eventfd.
+ */
+RPVC_Status_t RPVC_SB_GetPipeFd(RPVC_SbSubscriberId_t subscriberId, int *outFd);
+
+/**
+ * Sharded mode (RPVC_SB_MAX_SHARDS > 1) lets one worker thread per core
+ * publish without sharing pipes. Each pipe belongs to a shard, and only that
+ * shard's thread writes its queue and receives from it. A publish delivers
+ * straight to pipes of the caller's shard; copies for pipes of other shards
+ * go to a single-producer mailbox per (source shard, pipe), which the owner
+ * moves into the pipe in one batch whenever it receives. A post to an empty
+ * mailbox wakes a blocked receiver and the pipe's eventfd.
+ *
+ * Reject-policy pipes only veto publishes from their own shard; at drain time
+ * they drop like drop-newest. Filters, latest values and broadcast rings keep
+ * their single-publisher rule, so publish each such topic from one shard.
+ *
+ * RPVC_SB_BindShard sets the calling thread's shard (0 until set; no bus
+ * state is touched). RPVC_SB_SetPipeShard assigns a pipe, before traffic.
+ * Only sharded builds keep a thread-local shard; with one shard both calls
+ * accept shard 0 only, so targets without TLS support need nothing extra.
+ */
+RPVC_Status_t RPVC_SB_BindShard(uint8_t shardId);
+RPVC_Status_t RPVC_SB_SetPipeShard(RPVC_SbSubscriberId_t subscriberId, uint8_t shardId);
+
+/**
+ * Copy the bus counters. Every counter is read on its own without locking,
+ * so publishers never wait on a snapshot, but counters taken while traffic
+ * flows may be a few messages apart. The latency histogram stays empty
+ * unless the library is built with RPVC_SB_ENABLE_TIMESTAMPS=1.
+ */
+RPVC_Status_t RPVC_SB_GetStats(RPVC_SbStats_t *outStats);
+
 RPVC_Status_t RPVC_SB_Subscribe(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId);
+
+/**
+ * Subscribe a pipe with publish-side thinning. RPVC_SB_Publish checks the
+ * options before enqueueing, so messages filtered out never reach the pipe.
+ * Content matches are checked first, and a payload too short for a field
+ * never matches. Decimation then counts the matching messages; a message
+ * that survives it is still skipped if less than minIntervalUs has passed
+ * since the last one delivered. Subscribing again replaces the options.
+ * Options that thin anything hold one of RPVC_SB_MAX_FILTERS slots shared
+ * by every topic; a slot given up is free again from the next change on.
+ *
+ * Subscription changes never block publishers: they build a new copy of the
+ * route table and switch publishers to it in one step, writing filters and
+ * handlers into slots no publisher reads. A change waits for publishers
+ * still routing through the copy it reuses, sleeping a tick between checks
+ * once a short spin is over.
+ *
+ * @param options NULL behaves like RPVC_SB_Subscribe.
+ * @return Same as RPVC_SB_Subscribe; RPVC_ERR_INVALID_ARG for a match with a
+ *         bad width, operator or value, or a field past
+ *         RPVC_SB_MAX_PAYLOAD_SIZE; RPVC_ERR_NOT_READY if a minimum interval
+ *         is requested and the OSAL clock is unavailable;
+ *         RPVC_ERR_NO_RESOURCE if no filter slot is free.
+ */
+RPVC_Status_t RPVC_SB_SubscribeWithOptions(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId, const RPVC_SbSubscribeOptions_t *options);
 RPVC_Status_t RPVC_SB_Unsubscribe(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId);
 
+/**
+ * Register a handler that RPVC_SB_Publish calls synchronously, in the
+ * publisher's context, for every message with this ID. No pipe is involved,
+ * so there is no enqueue, dequeue or copy. Callback and pipe subscribers of
+ * the same ID coexist; callbacks run before the pipes are filled.
+ *
+ * Handlers must be short and must not publish the same message ID.
+ *
+ * @return RPVC_OK on success (also if already registered);
+ *         RPVC_ERR_INVALID_ARG; RPVC_ERR_OUT_OF_RANGE if the ID already has
+ *         RPVC_SB_MAX_CALLBACKS handlers.
+ */
+RPVC_Status_t RPVC_SB_SubscribeCallback(RPVC_SbMsgId_t messageId, RPVC_SbCallback_t callback, void *context);
+RPVC_Status_t RPVC_SB_UnsubscribeCallback(RPVC_SbMsgId_t messageId, RPVC_SbCallback_t callback, void *context);
+
+/**
+ * Give every message published on messageId a deadline ttlUs after its
+ * publish, unless it carries its own (RPVC_SB_SetMessageDeadline). 0 turns
+ * the default off. The receive calls release expired messages unread, so a
+ * consumer that fell behind skips straight to current data.
+ */
+RPVC_Status_t RPVC_SB_SetTopicTtl(RPVC_SbMsgId_t messageId, uint32_t ttlUs);
+
+/**
+ * Credit-based flow control. A topic's credit is the room left in the
+ * fullest pipe it routes to (for a pipe of another shard, the caller's
+ * mailbox to it); UINT32_MAX with no pipes. A publisher that checks credit
+ * before publishing never has messages dropped or vetoed by a full pipe.
+ *
+ * RPVC_SB_WaitCredit blocks until the credit reaches minCredit (0 polls
+ * once). It marks the topic's pipes that are short of room and is woken only
+ * by the next receive on one of them, not by every receive on the bus.
+ * RPVC_SB_SetCreditCallback instead notifies without blocking: once a publish
+ * found one of the topic's pipes full (or a waiter marked it), that pipe's
+ * next receive calls it (NULL clears). The callback may be replaced while
+ * traffic flows; a receive calls either the old one or the new one, each
+ * with its own context.
+ *
+ * @return RPVC_OK; RPVC_ERR_INVALID_ARG; RPVC_ERR_TIMEOUT; RPVC_ERR_NOT_READY
+ *         without a clock for a finite wait; RPVC_ERR_NO_RESOURCE if no
+ *         semaphore is available.
+ */
+RPVC_Status_t RPVC_SB_GetCredit(RPVC_SbMsgId_t messageId, uint32_t *outCredit);
+RPVC_Status_t RPVC_SB_WaitCredit(RPVC_SbMsgId_t messageId, uint32_t minCredit, uint32_t timeoutMs);
+RPVC_Status_t RPVC_SB_SetCreditCallback(RPVC_SbMsgId_t messageId, RPVC_SbCreditCallback_t callback, void *context);
+
+/**
+ * Priority lanes. Each pipe has RPVC_SB_PRIORITY_LANES queues: priority 0
+ * is the queue set up by RPVC_SB_CreatePipe, and each higher priority has
+ * RPVC_SB_PRIORITY_LANE_DEPTH slots of its own under the same overflow
+ * policy. The receive calls always take from the most urgent non-empty lane,
+ * so commands and faults never wait behind bulk telemetry; order is kept
+ * within a lane only. Set a topic's default here, or a single message's
+ * priority with RPVC_SB_SetMessagePriority. In RPVC_SB_PublishBatch only
+ * priority-0 copies are vetoed up front by reject-policy pipes; a full
+ * higher lane drops its copy like drop-newest.
+ *
+ * @return RPVC_OK; RPVC_ERR_INVALID_ARG if priority >= RPVC_SB_PRIORITY_LANES.
+ */
+RPVC_Status_t RPVC_SB_SetTopicPriority(RPVC_SbMsgId_t messageId, uint8_t priority);
+
+/**
+ * Latch a message ID: the bus keeps a reference to the last message
+ * published on it, and RPVC_SB_Subscribe hands that message to each new
+ * subscriber, so a late starter learns state published only on change. The
+ * hand-off is made before the subscription takes effect, so the pipe
+ * receives it ahead of anything published afterwards; the subscriber's call
+ * never writes the pipe's queues itself. A pipe holds up to
+ * RPVC_SB_LATCH_HANDOFF_DEPTH of these between receives, further ones count
+ * as drops. The message keeps its original deadline. Disabling releases the
+ * held message.
+ */
+RPVC_Status_t RPVC_SB_SetTopicLatch(RPVC_SbMsgId_t messageId, bool enable);
+
+/**
+ * Keep the latest value of a message ID. Every publish of the ID overwrites
+ * it without waiting, payloads longer than maxSize are truncated, and readers
+ * copy the newest complete value in O(1) without consuming it. No pipe is
+ * needed; pipes and callbacks on the same ID keep working as before.
+ *
+ * Takes two memory pool blocks, held until RPVC_SB_Deinit.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG; RPVC_ERR_STATE if the ID
+ *         already keeps its latest value; memory pool errors.
+ */
+RPVC_Status_t RPVC_SB_CreateLatest(RPVC_SbMsgId_t messageId, size_t maxSize);
+
+/**
+ * Copy the latest value of a message ID. Never blocks publishers; retries
+ * only if they complete more than one write while the copy is being made.
+ *
+ * @param outSize     Optional: stored length of the value (before any
+ *                    truncation to bufferSize).
+ * @param outSequence Optional: number of values written so far; unchanged
+ *                    between calls means no new value.
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG; RPVC_ERR_NOT_FOUND if
+ *         the ID has no latest value; RPVC_ERR_OUT_OF_RANGE if nothing was
+ *         published yet.
+ */
+RPVC_Status_t RPVC_SB_ReadLatest(RPVC_SbMsgId_t messageId, uint8_t *outBuffer, size_t bufferSize, size_t *outSize, uint32_t *outSequence);
+
+/**
+ * Give a message ID one ring shared by all of its broadcast readers. A
+ * publish stores the message in the ring once (one reference, no per-reader
+ * queue) and each reader only advances its own cursor through it, so
+ * publish cost does not grow with the number of readers.
+ *
+ * The publisher never waits: when the slowest joined reader is a full ring
+ * behind, the message is dropped for every reader and counted in
+ * droppedFull. The ring keeps the last depth messages allocated until they
+ * are overwritten or the bus is deinitialized. Broadcast readers poll; they
+ * are not woken by publishes.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG (depth not a power of
+ *         two); RPVC_ERR_STATE if the ID already has a ring; memory pool
+ *         errors.
+ */
+RPVC_Status_t RPVC_SB_CreateBroadcast(RPVC_SbMsgId_t messageId, const RPVC_SbBroadcastConfig_t *config);
+
+/**
+ * Start a reader cursor at the current end of the ring; it sees messages
+ * published from now on. Reader IDs are chosen by the caller, like pipe IDs,
+ * and each one must be used from a single context.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG; RPVC_ERR_NOT_FOUND if
+ *         the ID has no ring; RPVC_ERR_STATE if the reader already joined.
+ */
+RPVC_Status_t RPVC_SB_JoinBroadcast(RPVC_SbMsgId_t messageId, uint8_t readerId);
+RPVC_Status_t RPVC_SB_LeaveBroadcast(RPVC_SbMsgId_t messageId, uint8_t readerId);
+
+/**
+ * Copy the reader's next message out of the ring.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_OUT_OF_RANGE if the reader is caught
+ *         up; RPVC_ERR_STATE if it has not joined; otherwise as
+ *         RPVC_SB_JoinBroadcast.
+ */
+RPVC_Status_t RPVC_SB_ReceiveBroadcast(RPVC_SbMsgId_t messageId, uint8_t readerId, uint8_t *outBuffer, size_t bufferSize);
+
+/**
+ * Take up to maxHandles of the reader's next messages without copying. Each
+ * handle is a reference of the caller's own; release it with
+ * RPVC_SB_ReleaseMessage.
+ */
+RPVC_Status_t RPVC_SB_ReceiveBroadcastBatch(RPVC_SbMsgId_t messageId, uint8_t readerId, RPVC_SbMsgHandle_t *outHandles, size_t maxHandles, size_t *outCount);
+
+/**
+ * Hand a message to the callbacks registered for its ID and queue it on
+ * every active pipe subscribed to it; each full pipe applies its overflow
+ * policy. IDs created with RPVC_SB_CreateLatest also store it as their
+ * latest value, and IDs with a broadcast ring append it there.
+ *
+ * @return RPVC_OK if at least one callback, pipe, latest value or
+ *         broadcast ring took the message;
+ *         RPVC_ERR_OUT_OF_RANGE if none did (full or filtered out);
+ *         RPVC_ERR_NO_RESOURCE (nothing queued) if a full reject-policy pipe
+ *         refused it; RPVC_ERR_NOT_READY if a rate-limited subscription
+ *         cannot read the clock.
+ */
 RPVC_Status_t RPVC_SB_Publish(RPVC_SbMsgHandle_t messageHandle);
+
+/**
+ * RPVC_SB_Publish that skips one pipe, so a component relaying messages
+ * into the bus (e.g. a bridge) does not get its own traffic echoed back.
+ */
+RPVC_Status_t RPVC_SB_PublishExcluding(RPVC_SbMsgHandle_t messageHandle, RPVC_SbSubscriberId_t excludedSubscriberId);
 RPVC_Status_t RPVC_SB_Receive(RPVC_SbSubscriberId_t subscriberId, uint8_t *outBuffer, size_t bufferSize);
+
+/**
+ * Receive from a pipe, blocking until a message arrives or the timeout expires.
+ *
+ * The caller sleeps on a per-pipe OSAL semaphore that publishers signal only
+ * when the pipe goes from empty to non-empty. The semaphore is taken from the
+ * OSAL pool on the first blocking call for that pipe.
+ *
+ * @param timeoutMs 0 to poll, RPVC_SB_WAIT_FOREVER to wait indefinitely.
+ * @return RPVC_OK on success; RPVC_ERR_TIMEOUT if nothing arrived in time;
+ *         RPVC_ERR_NO_RESOURCE if the OSAL cannot provide a semaphore;
+ *         otherwise the same errors as RPVC_SB_Receive.
+ */
+RPVC_Status_t RPVC_SB_ReceiveTimeout(RPVC_SbSubscriberId_t subscriberId, uint8_t *outBuffer, size_t bufferSize, uint32_t timeoutMs);
 RPVC_Status_t RPVC_SB_Flush(RPVC_SbSubscriberId_t subscriberId);
 
+/**
+ * Publish several messages with one pass over the bus state.
+ *
+ * Routes are resolved once per distinct message ID and each pipe's shared
+ * indices are updated once per batch, so a pipe's receiver (and a blocked
+ * RPVC_SB_ReceiveTimeout) sees the whole batch at once. Per-pipe order
+ * follows the order of the handles array. A handler that changes
+ * subscriptions splits the update where it returns, so a latched message it
+ * hands over lands between the copies before and after it.
+ *
+ * @param messageHandles Array of count non-NULL handles.
+ * @return RPVC_OK if every message reached at least one callback or pipe;
+ *         RPVC_ERR_OUT_OF_RANGE if some did not; RPVC_ERR_INVALID_ARG
+ *         (nothing published) if any handle or message ID is invalid;
+ *         RPVC_ERR_NO_RESOURCE (nothing published) if the batch does not fit
+ *         a reject-policy pipe.
+ */
+RPVC_Status_t RPVC_SB_PublishBatch(const RPVC_SbMsgHandle_t *messageHandles, size_t count);
+
+/**
+ * Take up to maxHandles messages from a pipe without copying payloads.
+ *
+ * Each returned handle carries the reference the pipe held; read it with
+ * RPVC_SB_GetMessagePayload and give it back with RPVC_SB_ReleaseMessage.
+ *
+ * @param outCount Number of handles written (0 when the pipe is empty).
+ * @return RPVC_OK if at least one handle was returned;
+ *         RPVC_ERR_OUT_OF_RANGE if the pipe is empty or inactive.
+ */
+RPVC_Status_t RPVC_SB_ReceiveBatch(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgHandle_t *outHandles, size_t maxHandles, size_t *outCount);
+
+/**
+ * Create a message holding a copy of messageData (truncated to
+ * RPVC_SB_MAX_PAYLOAD_SIZE). The caller owns one reference and must drop it
+ * with RPVC_SB_ReleaseMessage once it no longer needs the handle.
+ *
+ * With RPVC_SB_MESSAGE_SLAB_SLOTS set (the default on POSIX hosts), messages
+ * over half a cache line that fit RPVC_SB_MESSAGE_SLAB_SLOT_SIZE (with the
+ * header) live in the bus's own slab, each starting on a cache line with the
+ * header first, so routing a message touches a single line. Smaller
+ * messages take the best-fitting memory pool class, and larger ones, or any
+ * once the slab is full, come from the pool too.
+ */
 RPVC_Status_t RPVC_SB_CreateMessage(RPVC_SbMsgId_t messageId, const uint8_t *messageData, size_t messageSize, RPVC_SbMsgHandle_t *outMessageHandle);
 
+/**
+ * Loan a bus-owned message block so the payload can be written in place
+ * (directly by a driver, DMA or a serializer) instead of being copied in.
+ *
+ * @param messageSize Payload length in bytes, at most RPVC_SB_MAX_PAYLOAD_SIZE.
+ * @param outWritePtr Receives the payload area, valid until the loan is published.
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG; RPVC_ERR_NO_MEMORY.
+ */
+RPVC_Status_t RPVC_SB_LoanMessage(RPVC_SbMsgId_t messageId, size_t messageSize, RPVC_SbMsgHandle_t *outMessageHandle, uint8_t **outWritePtr);
+
+/**
+ * Publish a loaned message and hand the loan back to the bus. The handle
+ * must not be used afterwards, whether or not any pipe took the message.
+ *
+ * @return Same as RPVC_SB_Publish; RPVC_ERR_STATE if the handle is not an
+ *         outstanding loan.
+ */
+RPVC_Status_t RPVC_SB_PublishLoaned(RPVC_SbMsgHandle_t messageHandle);
+
+/**
+ * Drop the caller's reference to a message. Pipes hold their own references,
+ * so the block goes back to the pool when the last holder lets go.
+ */
 RPVC_Status_t RPVC_SB_ReleaseMessage(RPVC_SbMsgHandle_t messageHandle);
 
+RPVC_Status_t RPVC_SB_GetMessagePayload(RPVC_SbMsgHandle_t messageHandle, const uint8_t **outData, size_t *outSize);
+RPVC_Status_t RPVC_SB_GetMessageId(RPVC_SbMsgHandle_t messageHandle, RPVC_SbMsgId_t *outMessageId);
+
+/**
+ * Expire a message ttlUs from now, overriding its topic's TTL; 0 clears it.
+ * Set it between create (or loan) and publish. Receive, ReceiveTimeout and
+ * ReceiveBatch release copies found past their deadline and count them in
+ * the pipe and topic stats; latest values, broadcast rings and callbacks
+ * ignore deadlines.
+ *
+ * @return RPVC_OK; RPVC_ERR_INVALID_ARG; RPVC_ERR_STATE while the message is
+ *         queued somewhere; RPVC_ERR_NOT_READY without a clock.
+ */
+RPVC_Status_t RPVC_SB_SetMessageDeadline(RPVC_SbMsgHandle_t messageHandle, uint32_t ttlUs);
+
+/**
+ * Queue a message in the lane of priority, whatever its topic's default
+ * (RPVC_SB_SetTopicPriority). Set it between create (or loan) and publish;
+ * it is kept across publishes.
+ *
+ * @return RPVC_OK; RPVC_ERR_INVALID_ARG; RPVC_ERR_STATE while the message is
+ *         queued somewhere.
+ */
+RPVC_Status_t RPVC_SB_SetMessagePriority(RPVC_SbMsgHandle_t messageHandle, uint8_t priority);
+
+/**
+ * Service handler for RPVC_SB_Serve. Writes up to replyCapacity bytes to
+ * reply and their count to outReplySize. The returned status travels back
+ * to the requester; a reply is only carried with RPVC_OK.
+ */
+typedef RPVC_Status_t (*RPVC_SbServiceHandler_t)(RPVC_SbMsgId_t serviceId, const uint8_t *request, size_t requestSize,
+                                                 uint8_t *reply, size_t replyCapacity, size_t *outReplySize, void *context);
+
+/**
+ * Call a service: publish request on serviceId and block until the matching
+ * reply lands in replyPipeId or timeoutMs expires (RPVC_SB_WAIT_FOREVER to
+ * wait indefinitely). The reply is copied to outReply, truncated to
+ * replyBufferSize; outReplySize (optional) gets its full size.
+ *
+ * Each request carries a correlation ID and its reply pipe, and the server
+ * writes the reply straight into that pipe, so a call costs two queue hops.
+ * Do not subscribe the reply pipe to anything: messages that are not the
+ * awaited reply are discarded. Create it with RPVC_SB_CreatePipe first; the
+ * first request activates it.
+ *
+ * The request itself is published like any other message, and a pipe's queue
+ * has a single producer. Requests may only overlap when each requester is
+ * bound to a shard of its own (RPVC_SB_BindShard) and has its own reply
+ * pipe; otherwise make every call from the one publishing context.
+ *
+ * @return The handler's status on a reply; RPVC_ERR_TIMEOUT;
+ *         RPVC_ERR_NOT_READY if replyPipeId was never created;
+ *         RPVC_ERR_OUT_OF_RANGE if nothing serves serviceId;
+ *         other RPVC_SB_Publish errors.
+ */
+RPVC_Status_t RPVC_SB_Request(RPVC_SbMsgId_t serviceId, RPVC_SbSubscriberId_t replyPipeId, const uint8_t *request, size_t requestSize,
+                              uint8_t *outReply, size_t replyBufferSize, size_t *outReplySize, uint32_t timeoutMs);
+
+/**
+ * Serve requests from requestPipeId, a pipe subscribed to one or more service
+ * IDs. Waits up to timeoutMs for the first request, then answers every
+ * request already queued and returns; call it in the server's loop. Other
+ * messages in the pipe are dropped. A reply is queued in the request's
+ * priority lane of the requester's pipe under its overflow policy; one that
+ * is dropped there counts against the service ID, and the requester times out.
+ *
+ * @return RPVC_OK if at least one message was handled; RPVC_ERR_TIMEOUT;
+ *         RPVC_ERR_OUT_OF_RANGE if the pipe does not exist.
+ */
+RPVC_Status_t RPVC_SB_Serve(RPVC_SbSubscriberId_t requestPipeId, RPVC_SbServiceHandler_t handler, void *context, uint32_t timeoutMs);
+
 RPVC_EXTERN_C_END
 
 #endif // RPVC_SOFTWAREBUS_H
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef RPVC_SOFTWAREBUS_BRIDGE_H
+#define RPVC_SOFTWAREBUS_BRIDGE_H
+
+/*
+ * Software Bus bridge for host (RPVC_OS=posix) builds.
+ *
+ * A bridge drains a local pipe subscribed to a set of message IDs and sends
+ * the messages to a peer bridge over UDP or Unix datagram sockets. Several
+ * small messages are coalesced into one datagram, held no longer than the
+ * flush deadline. The peer republishes them on its own bus, skipping its
+ * bridge pipe so traffic is never echoed back. Applications on either side
+ * keep using the plain RPVC_SB_* API.
+ *
+ * The socket is connected to the peer (for Unix sockets as soon as the peer
+ * is bound), and datagrams from any other sender are discarded, so only the
+ * configured peer can publish on the local bus.
+ *
+ * RPVC_SB_BridgePoll republishes in the caller's context, so call it from
+ * the context that publishes the forwarded IDs (see RPVC_SB_Publish).
+ */
+
+#include "compile_time.h"
+#include "core_types.h"
+#include "SoftwareBus.h"
+#include <stddef.h>
+#include <sys/socket.h>
+
+#define RPVC_SB_BRIDGE_MAX_DATAGRAM 1472 // fits one Ethernet frame over UDP/IPv4
+#define RPVC_SB_BRIDGE_BATCH 8           // datagrams per sendmmsg/recvmmsg call
+
+typedef enum {
+    RPVC_SB_BRIDGE_UDP = 0, // addresses are "a.b.c.d:port"
+    RPVC_SB_BRIDGE_UNIX     // addresses are socket paths
+} RPVC_SbBridgeTransport_t;
+
+typedef struct {
+    RPVC_SbBridgeTransport_t transport;
+    const char *localAddress;
+    const char *peerAddress;
+    const RPVC_SbMsgId_t *messageIds; // forwarded to the peer
+    size_t messageIdCount;
+    RPVC_SbSubscriberId_t pipeId;     // local pipe reserved for the bridge
+    uint32_t flushDeadlineUs;         // longest a message waits to be coalesced, 0 sends on every poll
+    size_t maxDatagramSize;           // 0 for RPVC_SB_BRIDGE_MAX_DATAGRAM
+} RPVC_SbBridgeConfig_t;
+
+typedef struct {
+    uint32_t messagesSent;
+    uint32_t datagramsSent;
+    uint32_t messagesReceived;
+    uint32_t datagramsReceived;
+    uint32_t sendErrors;      // datagrams the socket refused (peer down, buffer full)
+    uint32_t malformedDatagrams;
+    uint32_t foreignDatagrams; // sent by someone other than the peer, discarded
+} RPVC_SbBridgeStats_t;
+
+// Caller-owned bridge instance; fields are private
+typedef struct {
+    int fd;
+    RPVC_SbBridgeTransport_t transport;
+    RPVC_SbSubscriberId_t pipeId;
+    uint32_t flushDeadlineUs;
+    size_t maxDatagramSize;
+    struct sockaddr_storage peer;
+    socklen_t peerLength;
+    bool connected;      // the socket only exchanges datagrams with peer
+    char localPath[108]; // unlinked on close (Unix transport)
+    uint8_t txBuffers[RPVC_SB_BRIDGE_BATCH][RPVC_SB_BRIDGE_MAX_DATAGRAM];
+    size_t txLengths[RPVC_SB_BRIDGE_BATCH];
+    uint32_t txCount;    // closed datagrams waiting to be sent
+    uint64_t openSinceUs; // first record of the open datagram
+    uint8_t rxBuffers[RPVC_SB_BRIDGE_BATCH][RPVC_SB_BRIDGE_MAX_DATAGRAM];
+    RPVC_SbBridgeStats_t stats;
+} RPVC_SbBridge_t;
+
+RPVC_EXTERN_C_BEGIN
+
+/**
+ * Bind the local socket and subscribe the bridge pipe to the forwarded IDs.
+ * The Software Bus must be initialized. On failure nothing stays subscribed.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG for a bad config or
+ *         address; RPVC_ERR_NO_RESOURCE if the socket cannot be set up;
+ *         RPVC_SB_Subscribe errors.
+ */
+RPVC_Status_t RPVC_SB_BridgeOpen(RPVC_SbBridge_t *bridge, const RPVC_SbBridgeConfig_t *config);
+
+/**
+ * Forward what the bridge pipe holds, send datagrams whose deadline has
+ * passed and republish everything the peer sent. Never blocks.
+ */
+RPVC_Status_t RPVC_SB_BridgePoll(RPVC_SbBridge_t *bridge);
+
+/** Send every pending datagram now, regardless of the deadline. */
+RPVC_Status_t RPVC_SB_BridgeFlush(RPVC_SbBridge_t *bridge);
+
+RPVC_Status_t RPVC_SB_BridgeGetStats(const RPVC_SbBridge_t *bridge, RPVC_SbBridgeStats_t *outStats);
+
+RPVC_Status_t RPVC_SB_BridgeClose(RPVC_SbBridge_t *bridge);
+
+RPVC_EXTERN_C_END
+
+#endif // RPVC_SOFTWAREBUS_BRIDGE_H
@@ -0,0 +1,143 @@
+#ifndef RPVC_SOFTWAREBUS_LOG_H
+#define RPVC_SOFTWAREBUS_LOG_H
+
+/*
+ * Software Bus record and replay for host (RPVC_OS=posix) builds.
+ *
+ * The recorder drains a local pipe subscribed to a set of message IDs and
+ * appends each message, stamped with the monotonic clock, to a log split into
+ * segments <basePath>.0000, <basePath>.0001, ... Records are collected in a
+ * RPVC_SB_LOG_BUFFER_SIZE buffer and written in one call; a closed segment
+ * ends with a sparse time index.
+ *
+ * The player maps one segment at a time and republishes its records, either
+ * at the recorded pace or as fast as the bus takes them, and can seek by
+ * time. Segments left without an index (the recorder was killed) still play;
+ * seeking in them scans from the start of the segment.
+ *
+ * Both structures are large; keep them static rather than on the stack.
+ */
+
+#include "compile_time.h"
+#include "core_types.h"
+#include "SoftwareBus.h"
+#include <stddef.h>
+
+#define RPVC_SB_LOG_BUFFER_SIZE (64U * 1024U)                  // recorder write size
+#define RPVC_SB_LOG_MAX_INDEX 1024                             // index entries per segment, one per write
+#define RPVC_SB_LOG_DEFAULT_SEGMENT_SIZE (16U * 1024U * 1024U)
+#define RPVC_SB_LOG_MAX_SEGMENT_SIZE (RPVC_SB_LOG_MAX_INDEX * RPVC_SB_LOG_BUFFER_SIZE)
+#define RPVC_SB_LOG_MAX_SEGMENTS 10000
+#define RPVC_SB_LOG_PATH_MAX 256
+
+typedef struct {
+    const char *basePath;             // segment files get a .NNNN suffix
+    const RPVC_SbMsgId_t *messageIds; // recorded IDs
+    size_t messageIdCount;
+    RPVC_SbSubscriberId_t pipeId;     // local pipe reserved for the recorder
+    uint32_t segmentSize;             // bytes per segment, 0 for RPVC_SB_LOG_DEFAULT_SEGMENT_SIZE
+} RPVC_SbRecorderConfig_t;
+
+typedef struct {
+    uint64_t timeUs; // first record of a write, monotonic clock
+    uint64_t offset; // its position in the segment
+} RPVC_SbLogIndexEntry_t;
+
+// Caller-owned recorder instance; fields are private
+typedef struct {
+    int fd;
+    char basePath[RPVC_SB_LOG_PATH_MAX];
+    RPVC_SbSubscriberId_t pipeId;
+    uint32_t segmentSize;
+    uint32_t segmentNumber;
+    uint64_t segmentOffset; // bytes of the open segment already written
+    uint8_t buffer[RPVC_SB_LOG_BUFFER_SIZE];
+    size_t bufferLength;
+    RPVC_SbLogIndexEntry_t index[RPVC_SB_LOG_MAX_INDEX];
+    uint32_t indexCount;
+    uint32_t writeErrors; // writes that failed; their records are lost
+} RPVC_SbRecorder_t;
+
+typedef enum {
+    RPVC_SB_PLAY_RECORDED_TIMING = 0, // keep the gaps between records
+    RPVC_SB_PLAY_FAST                 // publish back to back
+} RPVC_SbPlayMode_t;
+
+// Caller-owned player instance; fields are private
+typedef struct {
+    char basePath[RPVC_SB_LOG_PATH_MAX];
+    RPVC_SbPlayMode_t mode;
+    uint32_t segmentNumber;
+    const uint8_t *map;     // mapped segment, NULL past the last one
+    size_t mapSize;
+    size_t recordsEnd;      // start of the index footer, or the file size
+    const RPVC_SbLogIndexEntry_t *index;
+    uint32_t indexCount;
+    size_t position;        // next record in the mapped segment
+    bool anchored;          // recorded timing: anchorLogUs plays at anchorWallUs (both monotonic)
+    uint64_t anchorLogUs;
+    uint64_t anchorWallUs;
+} RPVC_SbPlayer_t;
+
+RPVC_EXTERN_C_BEGIN
+
+/**
+ * Create segment 0 and subscribe the recorder pipe to the recorded IDs. The
+ * Software Bus must be initialized. On failure nothing stays subscribed and
+ * segment 0 is removed again.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG for a bad config;
+ *         RPVC_ERR_NO_RESOURCE if the file cannot be created;
+ *         RPVC_SB_Subscribe errors.
+ */
+RPVC_Status_t RPVC_SB_RecorderOpen(RPVC_SbRecorder_t *recorder, const RPVC_SbRecorderConfig_t *config);
+
+/**
+ * Append everything the recorder pipe holds. Writes only when the buffer
+ * fills, so most calls never touch the file. Records carry the time of the
+ * poll that drained them; poll at least as often as the replay needs to be
+ * accurate.
+ */
+RPVC_Status_t RPVC_SB_RecorderPoll(RPVC_SbRecorder_t *recorder);
+
+/** Write the buffered records now. */
+RPVC_Status_t RPVC_SB_RecorderFlush(RPVC_SbRecorder_t *recorder);
+
+/** Flush, finish the open segment with its index and release the pipe. */
+RPVC_Status_t RPVC_SB_RecorderClose(RPVC_SbRecorder_t *recorder);
+
+/**
+ * Map the first segment of a log for replay.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG; RPVC_ERR_NOT_FOUND if
+ *         there is no segment 0; RPVC_ERR_INTEGRITY if it is not a log.
+ */
+RPVC_Status_t RPVC_SB_PlayerOpen(RPVC_SbPlayer_t *player, const char *basePath, RPVC_SbPlayMode_t mode);
+
+/**
+ * Move to the first record at or after timeUs (wall clock, microseconds).
+ * The wall time is mapped onto the records' monotonic time through the
+ * header of the segment it falls in. Recorded timing restarts from there.
+ *
+ * @return RPVC_OK; RPVC_ERR_OUT_OF_RANGE if the log ends before timeUs.
+ */
+RPVC_Status_t RPVC_SB_PlayerSeek(RPVC_SbPlayer_t *player, uint64_t timeUs);
+
+/**
+ * Republish up to maxRecords records that are due; never sleeps. With
+ * recorded timing, call it again after a short wait until it reports the
+ * end. A record that cannot get a message from the memory pool stays next
+ * in line, so a fast replay simply pauses until subscribers catch up.
+ * Publish results are not checked: a record is played once, like a live
+ * publish, whether or not a pipe had room.
+ *
+ * @return RPVC_OK with the number published in outCount (may be 0);
+ *         RPVC_ERR_OUT_OF_RANGE once every record has been played.
+ */
+RPVC_Status_t RPVC_SB_PlayerPoll(RPVC_SbPlayer_t *player, size_t maxRecords, size_t *outCount);
+
+RPVC_Status_t RPVC_SB_PlayerClose(RPVC_SbPlayer_t *player);
+
+RPVC_EXTERN_C_END
+
+#endif // RPVC_SOFTWAREBUS_LOG_H
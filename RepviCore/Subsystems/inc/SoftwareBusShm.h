@@ -0,0 +1,78 @@
+#ifndef RPVC_SOFTWAREBUS_SHM_H
+#define RPVC_SOFTWAREBUS_SHM_H
+
+/*
+ * Inter-process Software Bus for host (RPVC_OS=posix) builds.
+ *
+ * Message blocks, routes and pipe rings live in one POSIX shared memory
+ * segment and refer to each other by index, so every process can map it at
+ * its own address. Any process may publish; each pipe has one receiving
+ * process. Receivers sleep on a futex in the segment (Linux), which
+ * publishers in other processes wake directly.
+ *
+ * The segment has no owner: a process that dies while holding a block leaks
+ * it until the segment is destroyed and recreated.
+ */
+
+#include "compile_time.h"
+#include "core_types.h"
+#include "SoftwareBus.h"
+#include <stddef.h>
+
+#define RPVC_SB_SHM_BLOCKS 256     // message blocks in the segment, at most 65534
+#define RPVC_SB_SHM_PIPE_DEPTH 64  // ring slots per pipe, power of two
+
+typedef struct {
+    void *segment; // process-local mapping
+} RPVC_SbShm_t;
+
+RPVC_EXTERN_C_BEGIN
+
+/**
+ * Create and initialize a named segment (e.g. "/rpvc_sb").
+ *
+ * @return RPVC_OK on success; RPVC_ERR_INVALID_ARG; RPVC_ERR_STATE if a
+ *         segment with that name already exists; RPVC_ERR_NO_RESOURCE if
+ *         the OS refuses the segment.
+ */
+RPVC_Status_t RPVC_SB_ShmCreate(const char *name, RPVC_SbShm_t *outBus);
+
+/**
+ * Map an existing segment created by another process.
+ *
+ * @return RPVC_OK on success; RPVC_ERR_NOT_FOUND if it does not exist;
+ *         RPVC_ERR_INTEGRITY if its layout does not match this build.
+ */
+RPVC_Status_t RPVC_SB_ShmAttach(const char *name, RPVC_SbShm_t *outBus);
+
+RPVC_Status_t RPVC_SB_ShmDetach(RPVC_SbShm_t *bus);
+
+/** Remove the name; processes still attached keep their mapping. */
+RPVC_Status_t RPVC_SB_ShmDestroy(const char *name);
+
+RPVC_Status_t RPVC_SB_ShmSubscribe(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId);
+RPVC_Status_t RPVC_SB_ShmUnsubscribe(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId);
+
+/**
+ * Copy a message into a shared block and queue it on every subscribed pipe.
+ * Full pipes skip the message and count a drop.
+ *
+ * @return RPVC_OK if at least one pipe took it; RPVC_ERR_OUT_OF_RANGE if
+ *         none did; RPVC_ERR_NO_MEMORY if no block is free.
+ */
+RPVC_Status_t RPVC_SB_ShmPublish(RPVC_SbShm_t *bus, RPVC_SbMsgId_t messageId, const uint8_t *data, size_t size);
+
+/**
+ * Take the oldest message of a pipe, waiting up to timeoutMs for one.
+ *
+ * @param outSize Optional; receives the payload length before truncation.
+ * @param timeoutMs 0 to poll, RPVC_SB_WAIT_FOREVER to wait indefinitely.
+ * @return RPVC_OK on success; RPVC_ERR_TIMEOUT if nothing arrived in time.
+ */
+RPVC_Status_t RPVC_SB_ShmReceive(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, uint8_t *outBuffer, size_t bufferSize, size_t *outSize, uint32_t timeoutMs);
+
+RPVC_Status_t RPVC_SB_ShmGetPipeDropCount(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, uint32_t *outDropCount);
+
+RPVC_EXTERN_C_END
+
+#endif // RPVC_SOFTWAREBUS_SHM_H
@@ -0,0 +1,207 @@
+#ifndef RPVC_SOFTWAREBUS_TOPIC_HPP
+#define RPVC_SOFTWAREBUS_TOPIC_HPP
+
+/*
+ * Typed C++ view of the Software Bus.
+ *
+ * A Topic binds a message ID to a payload type at compile time, so the ID,
+ * the size and the copy rules are checked by the compiler and nothing is cast
+ * by hand. Publishing writes straight into a loaned message; receiving hands
+ * out the queued message itself, so neither side copies the payload twice.
+ *
+ *     struct Imu { float accel[3]; float gyro[3]; };
+ *     using ImuTopic = RPVC::Topic<3, Imu>;
+ *
+ *     ImuTopic::Publish(sample);
+ *     RPVC::Sample<Imu> imu;
+ *     if (ImuTopic::Receive(pipe, imu) == RPVC_OK) { use(imu->gyro); }
+ */
+
+#include "SoftwareBus.h"
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace RPVC {
+    // A received message; keeps the pipe's reference until destroyed or reset
+    template<typename T>
+    class Sample {
+        public:
+        Sample() = default;
+        Sample(const Sample &) = delete;
+        Sample &operator=(const Sample &) = delete;
+
+        Sample(Sample &&other) noexcept : handle_(other.handle_), data_(other.data_)
+        {
+            other.handle_ = nullptr;
+            other.data_ = nullptr;
+        }
+
+        Sample &operator=(Sample &&other) noexcept
+        {
+            if (this != &other) {
+                Reset();
+                handle_ = other.handle_;
+                data_ = other.data_;
+                other.handle_ = nullptr;
+                other.data_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~Sample()
+        {
+            Reset();
+        }
+
+        void Reset()
+        {
+            if (handle_ != nullptr) {
+                (void)RPVC_SB_ReleaseMessage(handle_);
+                handle_ = nullptr;
+                data_ = nullptr;
+            }
+        }
+
+        bool IsValid() const
+        {
+            return data_ != nullptr;
+        }
+
+        const T &Get() const
+        {
+            return *data_;
+        }
+
+        const T &operator*() const
+        {
+            return *data_;
+        }
+
+        const T *operator->() const
+        {
+            return data_;
+        }
+
+        private:
+        template<RPVC_SbMsgId_t, typename> friend class Topic;
+
+        void Adopt(RPVC_SbMsgHandle_t handle, const uint8_t *payload)
+        {
+            Reset();
+            handle_ = handle;
+            data_ = reinterpret_cast<const T*>(payload);
+        }
+
+        RPVC_SbMsgHandle_t handle_ = nullptr;
+        const T *data_ = nullptr;
+    };
+
+    template<RPVC_SbMsgId_t MsgId, typename T>
+    class Topic {
+        static_assert(MsgId < RPVC_SB_MAX_MESSAGE_ID, "message ID out of range");
+        static_assert(std::is_trivially_copyable<T>::value, "payload types are copied as raw bytes");
+        static_assert(sizeof(T) <= RPVC_SB_MAX_PAYLOAD_SIZE, "payload does not fit a Software Bus message");
+        static_assert(alignof(T) <= 8, "message payloads are only 8-byte aligned");
+
+        public:
+        static constexpr RPVC_SbMsgId_t Id = MsgId;
+        static constexpr size_t Size = sizeof(T);
+
+        static RPVC_Status_t Subscribe(RPVC_SbSubscriberId_t subscriberId)
+        {
+            return RPVC_SB_Subscribe(subscriberId, MsgId);
+        }
+
+        static RPVC_Status_t Unsubscribe(RPVC_SbSubscriberId_t subscriberId)
+        {
+            return RPVC_SB_Unsubscribe(subscriberId, MsgId);
+        }
+
+        // Copies value into a loaned message; same results as RPVC_SB_Publish
+        static RPVC_Status_t Publish(const T &value)
+        {
+            RPVC_SbMsgHandle_t handle = nullptr;
+            uint8_t *writePtr = nullptr;
+            RPVC_Status_t status = RPVC_SB_LoanMessage(MsgId, sizeof(T), &handle, &writePtr);
+            if (status != RPVC_OK) {
+                return status;
+            }
+            std::memcpy(writePtr, &value, sizeof(T));
+            return RPVC_SB_PublishLoaned(handle);
+        }
+
+        // Lets fill build a value-initialized payload inside the message, with no
+        // staging copy; if fill throws, the loan goes back unpublished
+        template<typename Fill>
+        static RPVC_Status_t PublishInPlace(Fill &&fill)
+        {
+            RPVC_SbMsgHandle_t handle = nullptr;
+            uint8_t *writePtr = nullptr;
+            RPVC_Status_t status = RPVC_SB_LoanMessage(MsgId, sizeof(T), &handle, &writePtr);
+            if (status != RPVC_OK) {
+                return status;
+            }
+            LoanGuard guard{handle};
+            fill(*new (writePtr) T());
+            guard.handle = nullptr;
+            return RPVC_SB_PublishLoaned(handle);
+        }
+
+        /**
+         * Take the oldest message from a pipe without copying it. The pipe
+         * should carry this topic only: a message with another ID or size is
+         * released and reported as RPVC_ERR_INTEGRITY.
+         *
+         * @return RPVC_OK with out holding the message; otherwise the
+         *         RPVC_SB_ReceiveBatch errors.
+         */
+        static RPVC_Status_t Receive(RPVC_SbSubscriberId_t subscriberId, Sample<T> &out)
+        {
+            RPVC_SbMsgHandle_t handle = nullptr;
+            size_t count = 0;
+            RPVC_Status_t status = RPVC_SB_ReceiveBatch(subscriberId, &handle, 1, &count);
+            if (status != RPVC_OK) {
+                return status;
+            }
+
+            RPVC_SbMsgId_t messageId = 0;
+            const uint8_t *payload = nullptr;
+            size_t size = 0;
+            (void)RPVC_SB_GetMessageId(handle, &messageId);
+            (void)RPVC_SB_GetMessagePayload(handle, &payload, &size);
+            if (messageId != MsgId || size != sizeof(T)) {
+                (void)RPVC_SB_ReleaseMessage(handle);
+                return RPVC_ERR_INTEGRITY;
+            }
+            out.Adopt(handle, payload);
+            return RPVC_OK;
+        }
+
+        // Copying receive for small payloads, with the same ID and size checks
+        // as the zero-copy one; out is only written on RPVC_OK
+        static RPVC_Status_t Receive(RPVC_SbSubscriberId_t subscriberId, T &out)
+        {
+            Sample<T> sample;
+            RPVC_Status_t status = Receive(subscriberId, sample);
+            if (status == RPVC_OK) {
+                std::memcpy(&out, &sample.Get(), sizeof(T));
+            }
+            return status;
+        }
+
+        private:
+        struct LoanGuard {
+            RPVC_SbMsgHandle_t handle;
+
+            ~LoanGuard()
+            {
+                if (handle != nullptr) {
+                    (void)RPVC_SB_ReleaseMessage(handle);
+                }
+            }
+        };
+    };
+}
+
+#endif // RPVC_SOFTWAREBUS_TOPIC_HPP
@@ -1,49 +1,331 @@
 #include "SoftwareBus.h"
 #include "RPVC_MEMORYPOOL.h"
+#include "RPVC_OS.h"
+#include "RPVC_CompilerAbstraction.h"
 #include <string.h>
 
+#if defined(RPVC_OS_POSIX) && defined(__linux__)
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+    #define SB_USE_EVENTFD 1
+#else
+    #define SB_USE_EVENTFD 0
+#endif
+
 #define NOT_VALID_SUBSCRIBER_ID (RPVC_SbSubscriberId_t)(-1)
 
+#define SB_MSG_FLAG_LOANED 0x01U // payload handed out by RPVC_SB_LoanMessage, not yet published
+#define SB_MSG_FLAG_STAMPED 0x02U // publishTimeUs holds the last publish time
+#define SB_MSG_FLAG_REQUEST 0x04U // RPVC_SB_Request: rpcParam is the reply pipe
+#define SB_MSG_FLAG_REPLY 0x08U   // RPVC_SB_Serve: rpcParam is the handler status
+#define SB_MSG_FLAG_DEADLINE 0x10U // deadline set by RPVC_SB_SetMessageDeadline, kept across publishes
+#define SB_MSG_FLAG_EXPIRES 0x20U  // deadlineUs is valid for the queued copies
+#define SB_MSG_FLAG_PRIORITY 0x40U // priority set by RPVC_SB_SetMessagePriority, kept across publishes
+
+#define SB_CACHE_LINE 64
+#define SB_MAILBOX_MASK (RPVC_SB_SHARD_MAILBOX_DEPTH - 1U)
+#define SB_LATCH_MASK (RPVC_SB_LATCH_HANDOFF_DEPTH - 1U)
+#define SB_LATCH_SLOTS 3U
+#define SB_SPIN_LIMIT 64U // busy checks before a control call starts sleeping between them
+#define SB_SLAB_WORDS ((RPVC_SB_MESSAGE_SLAB_SLOTS + 31U) / 32U)
+#define SB_FILTER_SLOTS (UINT32_MAX >> (32U - RPVC_SB_MAX_FILTERS))
+#define SB_CALLBACK_SLOTS ((1U << RPVC_SB_MAX_CALLBACKS) - 1U)
+#define SB_LANE_BIT(priority) (1U << (RPVC_SB_PRIORITY_LANES - 1U - (uint32_t)(priority))) // most urgent lane lowest
+
+_Static_assert(RPVC_SB_MAX_PIPES <= 32, "pipe sets are tracked as 32-bit masks");
+_Static_assert(RPVC_SB_MAX_SHARDS >= 1 && RPVC_SB_MAX_SHARDS <= 255, "shard IDs are 8-bit");
+_Static_assert((RPVC_SB_SHARD_MAILBOX_DEPTH & SB_MAILBOX_MASK) == 0, "mailbox depth must be a power of two");
+_Static_assert(RPVC_SB_LATCH_HANDOFF_DEPTH >= 1 && (RPVC_SB_LATCH_HANDOFF_DEPTH & SB_LATCH_MASK) == 0,
+               "latch hand-off depth must be a power of two");
+_Static_assert(RPVC_SB_PRIORITY_LANES >= 1 && RPVC_SB_PRIORITY_LANES <= 32, "lane sets are tracked as 32-bit masks");
+_Static_assert(RPVC_SB_PRIORITY_LANE_DEPTH >= 1, "priority lanes need at least one slot");
+_Static_assert(RPVC_SB_MESSAGE_SLAB_SLOT_SIZE % SB_CACHE_LINE == 0, "slab slots must start on a cache line");
+_Static_assert(RPVC_SB_MAX_CONTENT_MATCHES >= 1 && RPVC_SB_MAX_CONTENT_MATCHES <= 255, "match counts are 8-bit");
+_Static_assert(RPVC_SB_MAX_FILTERS >= 1 && RPVC_SB_MAX_FILTERS <= 32, "filter slots are tracked as 32-bit masks");
+_Static_assert(RPVC_SB_MAX_CALLBACKS >= 1 && RPVC_SB_MAX_CALLBACKS <= 8, "handler slots are tracked as 8-bit masks");
+
+// Header first, payload sized to the message: allocated from the best-fitting pool class
 typedef struct RPVC_SbMsg_t {
-    uint8_t payload[RPVC_SB_MAX_PAYLOAD_SIZE];
+    uint32_t refCount; // atomic: creator + one per queued copy; freed when it drops to 0
     RPVC_SbMsgId_t messageId;
     uint16_t len;
-    uint8_t refCount;
+    uint8_t flags;
+    uint8_t rpcParam;       // requests: reply pipe; replies: handler status as int8_t
+    uint16_t correlationId; // pairs a reply with its request
+    uint32_t publishTimeUs; // low 32 bits of the clock, valid with SB_MSG_FLAG_STAMPED
+    uint32_t deadlineUs;    // low 32 bits of the clock, valid with SB_MSG_FLAG_EXPIRES
+    uint8_t priority;       // lane of the queued copies: its own with SB_MSG_FLAG_PRIORITY, else the topic's
+    uint8_t reserved[3];    // keeps the payload 8-byte aligned
+    uint8_t payload[];
 } RPVC_SbMsg_t;
 
+_Static_assert(offsetof(RPVC_SbMsg_t, payload) % 8 == 0, "payload must stay 8-byte aligned");
+_Static_assert(offsetof(RPVC_SbMsg_t, payload) <= SB_CACHE_LINE, "routing must only touch the first cache line");
+_Static_assert(RPVC_SB_MESSAGE_SLAB_SLOT_SIZE > sizeof(RPVC_SbMsg_t), "slab slots must hold a header and a payload");
+_Static_assert(sizeof(RPVC_SbMsg_t) + RPVC_SB_MAX_PAYLOAD_SIZE <= RPVC_MEMORYPOOL_MAX_BLOCK_SIZE,
+               "largest payload must fit the largest pool class");
+
+// head and tail run free up to indexLimit (a multiple of depth) so a stale
+// head seen by a preempted claimer cannot match again after one lap (ABA)
 typedef struct {
-    RPVC_SbMsgHandle_t buffer[RPVC_SB_MAX_QUEUE_DEPTH];
-    uint32_t head;
-    uint32_t tail;
-    uint32_t count;
+    RPVC_SbMsgHandle_t *buffer; // depth slots: the pipe's inline slots, a pool block or caller memory
+    uint32_t depth;
+    uint32_t indexLimit;
+    uint32_t head;  // atomic: claimed by CAS (receiver, or a drop-oldest publisher evicting)
+    uint32_t tail;  // atomic: publisher side, stored once the slot is written
+    uint32_t count; // atomic: wake-up accounting only, may dip below 0 while a publish completes
 } RPVC_SbQueue_t;
 
 typedef struct {
     RPVC_SbQueue_t queue;
+    RPVC_SbMsgHandle_t inlineBuffer[RPVC_SB_MAX_QUEUE_DEPTH]; // storage of unconfigured pipes
+    RPVC_SbOverflowPolicy_t overflowPolicy;
+    bool storageFromPool;
+    uint32_t dropCount; // atomic
+    uint32_t peakDepth; // written by the publisher only
+    uint32_t receivedCount; // atomic
+    uint32_t expiredCount; // atomic
+    RPVC_OS_Sem *volatile dataSem; // signalled on empty -> non-empty, NULL until a blocking receive
+    int32_t eventFd; // atomic: written on the same edge, -1 until RPVC_SB_GetPipeFd
+    uint8_t shard;   // the only shard that writes the queue; others post to its mailboxes
+    uint32_t starved; // atomic: a publish found it full since its receiver last took a message
+#if RPVC_SB_PRIORITY_LANES > 1
+    RPVC_SbQueue_t urgentLanes[RPVC_SB_PRIORITY_LANES - 1]; // priorities 1 and up; queue is priority 0
+    RPVC_SbMsgHandle_t urgentBuffer[RPVC_SB_PRIORITY_LANES - 1][RPVC_SB_PRIORITY_LANE_DEPTH];
+    uint32_t pendingLanes; // atomic: bit (RPVC_SB_PRIORITY_LANES - 1 - priority) set while the lane may hold messages
+#endif
+    // Latched messages of topics the pipe joined (see handOffLatched). Only
+    // subscription changes add to it; the receiver, or a producer about to
+    // queue behind them, takes them in order.
+    RPVC_SbMsgHandle_t latchHandoff[RPVC_SB_LATCH_HANDOFF_DEPTH]; // each holds a reference
+    uint32_t latchHead; // atomic: claimed by CAS
+    uint32_t latchTail; // atomic
+    bool isCreated;     // configured by RPVC_SB_CreatePipe; survives Flush
     bool isInitialized;
 } RPVC_SbPip_t;
 
+// Messages one shard hands to a pipe owned by another. Single producer (the
+// source shard), single consumer (the owner, while receiving); the ends sit
+// on their own cache lines. count gives the empty -> non-empty edge the way
+// the pipe queue's does.
+typedef struct {
+    RPVC_ALIGN(SB_CACHE_LINE) uint32_t tail; // atomic: source side, free running
+    RPVC_ALIGN(SB_CACHE_LINE) uint32_t head; // atomic: owner side, free running
+    uint32_t count; // atomic
+    RPVC_SbMsgHandle_t slots[RPVC_SB_SHARD_MAILBOX_DEPTH]; // each holds a reference
+} RPVC_SbMailbox_t;
+
+// A content match compiled to one range test: the field passes when
+// lo <= (field & mask) <= hi, or when it does not if invert is set
+typedef struct {
+    uint16_t offset;
+    uint8_t width;
+    uint8_t invert;
+    uint32_t mask;
+    uint32_t lo;
+    uint32_t hi;
+} RPVC_SbCompiledMatch_t;
+
+// Publish-side thinning for one subscription; only its pipe's publisher touches it
+typedef struct {
+    uint16_t decimation;     // 1 delivers every message
+    uint16_t phase;          // messages since the last delivered one, modulo decimation
+    uint32_t minIntervalUs;  // 0: no rate limit
+    uint32_t lastDeliveryUs; // low 32 bits of the clock; differences are wrap-safe
+    uint8_t matchCount;
+    uint16_t matchEnd;       // shorter payloads lack a field, so they never match
+    RPVC_SbCompiledMatch_t matches[RPVC_SB_MAX_CONTENT_MATCHES];
+} RPVC_SbRouteFilter_t;
+
+// The subscriptions of one message ID, as bit sets of pipes. The route names
+// the filter and handler slots in use; a change never rewrites a named slot
+// but fills a free one, and a slot it lets go of is only filled again once
+// the publishers that could still see it have left (see beginRouteChange).
+typedef struct {
+    uint32_t pipes;
+    uint32_t filteredPipes;    // pipes whose filter can skip messages
+    uint32_t rateLimitedPipes; // subset of filteredPipes that needs the clock
+    uint8_t filterSlots[RPVC_SB_MAX_PIPES]; // by pipe, into g_sbState.filters; set for filteredPipes only
+    uint8_t callbackMask;      // slots of the entry's handler table in use
+} RPVC_SbRoute_t;
+
+typedef struct {
+    RPVC_SbCallback_t callback;
+    void *context;
+} RPVC_SbCallbackEntry_t;
+
+typedef struct {
+    RPVC_SbCreditCallback_t callback;
+    void *context;
+} RPVC_SbCreditHandler_t;
+
+typedef struct {
+    uint16_t len;
+    uint8_t reserved[6]; // keeps data 8-byte aligned
+    uint8_t data[];
+} RPVC_SbLatestSlot_t;
+
+// Latest-value storage: a seqlock over two slots. Write n goes to slot n & 1,
+// so a reader copies the last completed write while the next one fills the
+// other slot, and a writer preempted mid-write never stalls readers.
+typedef struct {
+    uint32_t sequence; // atomic: 2 per completed write, odd while one is in progress
+    uint32_t capacity; // atomic; 0: not a latest-value topic
+    RPVC_SbLatestSlot_t *slots[2];
+} RPVC_SbLatestValue_t;
+
+// One ring shared by every reader of a broadcast topic. Sequences run free;
+// depth is a power of two so slot = sequence & mask stays valid across wrap.
+typedef struct {
+    RPVC_SbMsgHandle_t *ring; // NULL: not a broadcast topic; each slot holds the ring's reference
+    uint32_t ready;   // atomic: set once ring and mask are written, so the pointer itself stays plain
+    uint32_t mask;
+    uint32_t tail;    // atomic: next sequence to publish, stored once the slot is written
+    uint32_t gate;    // publisher's cached slowest cursor, refreshed only when the ring looks full
+    uint32_t readers; // atomic bit set of joined cursors
+    uint32_t cursors[RPVC_SB_MAX_BROADCAST_READERS]; // atomic: next sequence each reader takes
+    bool storageFromPool;
+} RPVC_SbBroadcast_t;
+
 typedef struct {
     RPVC_SbSubscriberId_t subscriberIds[RPVC_SB_MAX_SUBSCRIBERS]; // store the index of pipes here
+    RPVC_SbCallbackEntry_t callbacks[RPVC_SB_MAX_CALLBACKS]; // slots named by the route's callbackMask
     uint8_t count;
+    RPVC_SbLatestValue_t latest;
+    RPVC_SbBroadcast_t broadcast;
+    uint32_t ttlUs; // default lifetime of published messages, 0 for none
+    uint8_t priority; // lane of messages without one of their own
+    bool isLatched;
+    // The latch rotates through three slots: a publisher overwrites the one
+    // that is neither current nor named by a subscriber taking a reference
+    // (see takeLatched), so no message is released under that subscriber.
+    RPVC_SbMsgHandle_t latchSlots[SB_LATCH_SLOTS]; // each holds a reference
+    uint32_t latchCurrent; // atomic: slot + 1 of the last message published while latched, 0 for none
+    uint32_t latchWriter;  // atomic: held by the publisher latching a message
+    uint32_t latchHazard;  // atomic: slot + 1 a subscriber is taking a reference from, 0 for none
+    // Set like a latest value: setting n fills creditHandlers[n & 1], so the
+    // receiver copies a whole pair while the next one goes in the other slot
+    RPVC_SbCreditHandler_t creditHandlers[2];
+    uint32_t creditSequence; // atomic: 2 per completed set, odd while one is in progress
+    RPVC_SbTopicStats_t stats; // atomic counters
 }RPVC_SbRouteEntry_t;
 
+// Bus-owned message storage. A slot starts on a cache line, so the header
+// that publish and receive touch never shares a line with another message.
+typedef struct {
+    RPVC_ALIGN(SB_CACHE_LINE) uint8_t bytes[RPVC_SB_MESSAGE_SLAB_SLOT_SIZE];
+} RPVC_SbSlabSlot_t;
+
+// Publishers counted in one shard's read sections, on a line of their own
+typedef struct {
+    RPVC_ALIGN(SB_CACHE_LINE) uint32_t count[2]; // atomic: by snapshot
+} RPVC_SbRouteReaders_t;
+
+// An open read section: the snapshot it routes through and the reader
+// counts it holds, left again by leaveRoutes
+typedef struct {
+    uint32_t epoch;
+    uint32_t held; // bit per snapshot
+    RPVC_SbRouteReaders_t *readers;
+} RPVC_SbRouteSection_t;
+
+// Publishers route a message inside a read section on snapshots[routeEpoch & 1]
+// (see enterRoutes), which also covers the filter and handler slots the
+// snapshot names. A subscription change waits for the sections still open on
+// the other copy, refills it and flips the epoch, so a publish never blocks
+// on a change and never sees one half done. Entering a section is wait-free:
+// at most two read-modify-writes, on the reader counts of the publisher's
+// shard, so publishers on different shards write no line in common. The rest
+// of a publish is lock-free, not wait-free (evicting from a drop-oldest pipe
+// retries its head), so publishing as a whole is lock-free.
 typedef struct {
     RPVC_SbPip_t pipes[RPVC_SB_MAX_PIPES];
     RPVC_SbRouteEntry_t routes[RPVC_SB_MAX_MESSAGE_ID];
+    RPVC_SbRoute_t snapshots[2][RPVC_SB_MAX_MESSAGE_ID];
+    RPVC_SbRouteFilter_t filters[RPVC_SB_MAX_FILTERS]; // shared by every route, see RPVC_SbRoute_t
+    uint32_t filtersUsed[2]; // by snapshot: the filter slots it names
+    uint32_t routeEpoch;     // atomic
+    RPVC_SbRouteReaders_t routeReaders[RPVC_SB_MAX_SHARDS];
+    uint32_t routeWriter;    // atomic: held by the subscription change in progress
+    uint32_t latencyUs[RPVC_SB_LATENCY_BUCKETS]; // atomic
+    uint32_t nextCorrelationId; // atomic
+    RPVC_OS_Sem *volatile creditSem; // shared by every RPVC_SB_WaitCredit, NULL until one blocks
+    uint32_t creditSemClaimed; // atomic: set by the caller that allocates creditSem
+    uint32_t creditWaiters;    // atomic: callers blocked on creditSem
+#if RPVC_SB_MAX_SHARDS > 1
+    RPVC_SbMailbox_t mailboxes[RPVC_SB_MAX_SHARDS][RPVC_SB_MAX_PIPES]; // [source shard][pipe]
+#endif
+#if RPVC_SB_MESSAGE_SLAB_SLOTS > 0
+    RPVC_SbSlabSlot_t slab[RPVC_SB_MESSAGE_SLAB_SLOTS];
+    uint32_t slabUsed[SB_SLAB_WORDS]; // atomic: bit set while the slot holds a message
+#endif
     bool isInitialized;
 } RPVC_SbState_t;
 
 static RPVC_SbState_t g_sbState = {0};
+#if RPVC_SB_MAX_SHARDS > 1
+static RPVC_THREAD_LOCAL uint8_t t_shard; // shard the calling thread publishes from
+#endif
+
+static void dropReference(RPVC_SbMsgHandle_t messageHandle);
+static void handOffLatched(RPVC_SbRouteEntry_t *entry, RPVC_SbSubscriberId_t subscriberId);
+static uint32_t queuedInPipe(RPVC_SbPip_t *pipe);
+static void releaseQueued(RPVC_SbPip_t *pipe);
+
+static void initQueue(RPVC_SbQueue_t *queue, RPVC_SbMsgHandle_t *storage, uint32_t depth)
+{
+    queue->buffer = storage;
+    queue->depth = depth;
+    queue->indexLimit = depth * (UINT32_MAX / depth);
+    queue->head = 0;
+    queue->tail = 0;
+    queue->count = 0;
+}
+
+static void configurePipe(RPVC_SbPip_t *pipe, RPVC_SbMsgHandle_t *storage, uint32_t depth, RPVC_SbOverflowPolicy_t policy, bool fromPool)
+{
+    initQueue(&pipe->queue, storage, depth);
+#if RPVC_SB_PRIORITY_LANES > 1
+    for (size_t lane = 0; lane < RPVC_SB_PRIORITY_LANES - 1; lane++) {
+        initQueue(&pipe->urgentLanes[lane], pipe->urgentBuffer[lane], RPVC_SB_PRIORITY_LANE_DEPTH);
+    }
+    pipe->pendingLanes = 0;
+#endif
+    pipe->overflowPolicy = policy;
+    pipe->storageFromPool = fromPool;
+    pipe->dropCount = 0;
+    pipe->peakDepth = 0;
+    pipe->receivedCount = 0;
+    pipe->expiredCount = 0;
+}
+
+static void releasePipeStorage(RPVC_SbPip_t *pipe)
+{
+    if (pipe->storageFromPool) {
+        (void)RPVC_MEMORYPOOL_Free(pipe->queue.buffer);
+        pipe->storageFromPool = false;
+    }
+}
 
 static void initPipes() 
 {
     for (size_t i = 0; i < RPVC_SB_MAX_PIPES; i++) {
-        g_sbState.pipes[i].isInitialized = false;
-        g_sbState.pipes[i].queue.head = 0;
-        g_sbState.pipes[i].queue.tail = 0;
-        g_sbState.pipes[i].queue.count = 0;
+        RPVC_SbPip_t *pipe = &g_sbState.pipes[i];
+        pipe->isInitialized = false;
+        pipe->isCreated = false;
+        pipe->eventFd = -1;
+        configurePipe(pipe, pipe->inlineBuffer, RPVC_SB_MAX_QUEUE_DEPTH, RPVC_SB_OVERFLOW_DROP_NEWEST, false);
+    }
+}
+
+static void initSlab()
+{
+#if RPVC_SB_MESSAGE_SLAB_SLOTS > 0
+    // slots past the end in the last word stay permanently taken
+    if (RPVC_SB_MESSAGE_SLAB_SLOTS % 32 != 0) {
+        g_sbState.slabUsed[SB_SLAB_WORDS - 1] = ~((1U << (RPVC_SB_MESSAGE_SLAB_SLOTS % 32)) - 1U);
     }
+#endif
 }
 
 static void initRoutes() 
@@ -74,6 +356,7 @@ RPVC_Status_t RPVC_SB_Init(const RPVC_SoftwareBusConfig_t* config)
 
     initRoutes();
     initPipes();
+    initSlab();
     g_sbState.isInitialized = true;
     return RPVC_OK;
 }
@@ -84,6 +367,71 @@ RPVC_Status_t RPVC_SB_Deinit(void)
         return RPVC_ERR_NOT_READY;
     }
 
+    for (size_t i = 0; i < RPVC_SB_MAX_PIPES; i++) {
+        if (g_sbState.pipes[i].dataSem != NULL) {
+            (void)RPVC_OS_SemFree(g_sbState.pipes[i].dataSem);
+            g_sbState.pipes[i].dataSem = NULL;
+        }
+#if SB_USE_EVENTFD
+        if (g_sbState.pipes[i].eventFd >= 0) {
+            (void)close(g_sbState.pipes[i].eventFd);
+            g_sbState.pipes[i].eventFd = -1;
+        }
+#endif
+        RPVC_SbPip_t *pipe = &g_sbState.pipes[i];
+        releaseQueued(pipe);
+        releasePipeStorage(pipe);
+        for (uint32_t index = pipe->latchHead; index != pipe->latchTail; index++) {
+            dropReference(pipe->latchHandoff[index & SB_LATCH_MASK]);
+        }
+    }
+
+    if (g_sbState.creditSem != NULL) {
+        (void)RPVC_OS_SemFree(g_sbState.creditSem);
+        g_sbState.creditSem = NULL;
+    }
+
+#if RPVC_SB_MAX_SHARDS > 1
+    for (size_t source = 0; source < RPVC_SB_MAX_SHARDS; source++) {
+        for (size_t i = 0; i < RPVC_SB_MAX_PIPES; i++) {
+            RPVC_SbMailbox_t *mailbox = &g_sbState.mailboxes[source][i];
+            for (uint32_t index = mailbox->head; index != mailbox->tail; index++) {
+                dropReference(mailbox->slots[index & SB_MAILBOX_MASK]);
+            }
+        }
+    }
+#endif
+
+    for (size_t i = 0; i < RPVC_SB_MAX_MESSAGE_ID; i++) {
+        RPVC_SbLatestValue_t *latest = &g_sbState.routes[i].latest;
+        if (latest->capacity != 0) {
+            (void)RPVC_MEMORYPOOL_Free(latest->slots[0]);
+            (void)RPVC_MEMORYPOOL_Free(latest->slots[1]);
+            latest->capacity = 0;
+        }
+
+        RPVC_SbBroadcast_t *broadcast = &g_sbState.routes[i].broadcast;
+        if (broadcast->ring != NULL) {
+            for (uint32_t slot = 0; slot <= broadcast->mask; slot++) {
+                if (broadcast->ring[slot] != NULL) {
+                    dropReference(broadcast->ring[slot]);
+                }
+            }
+            if (broadcast->storageFromPool) {
+                (void)RPVC_MEMORYPOOL_Free(broadcast->ring);
+            }
+            broadcast->ring = NULL;
+            broadcast->ready = 0;
+        }
+
+        for (uint32_t slot = 0; slot < SB_LATCH_SLOTS; slot++) {
+            if (g_sbState.routes[i].latchSlots[slot] != NULL) {
+                dropReference(g_sbState.routes[i].latchSlots[slot]);
+                g_sbState.routes[i].latchSlots[slot] = NULL;
+            }
+        }
+    }
+
     g_sbState.isInitialized = false;
     return RPVC_OK;
 }
@@ -98,109 +446,313 @@ static bool IsValidMessageId(RPVC_SbMsgId_t messageId)
     return messageId < RPVC_SB_MAX_MESSAGE_ID;
 }
 
-RPVC_Status_t RPVC_SB_Subscribe(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId)
+RPVC_Status_t RPVC_SB_CreatePipe(RPVC_SbSubscriberId_t subscriberId, const RPVC_SbPipeConfig_t *config)
 {
     if (!g_sbState.isInitialized) {
         return RPVC_ERR_NOT_READY;
     }
 
-    if (!IsValidSubscriber(subscriberId) || !IsValidMessageId(messageId)) {
+    if (!IsValidSubscriber(subscriberId) || config == NULL ||
+        config->depth == 0 || config->depth > RPVC_SB_MAX_PIPE_DEPTH ||
+        config->overflowPolicy > RPVC_SB_OVERFLOW_REJECT) {
         return RPVC_ERR_INVALID_ARG;
     }
 
-    RPVC_SbRouteEntry_t *entry = &g_sbState.routes[messageId];
-    if (entry->count < RPVC_SB_MAX_SUBSCRIBERS) {
-        size_t emptyIndex = (size_t)(-1);
-        for (size_t i = 0; i < RPVC_SB_MAX_SUBSCRIBERS; i++) {
-            if (entry->subscriberIds[i] == subscriberId) {
-                return RPVC_OK; // Already subscribed
-            }
-
-            if (entry->subscriberIds[i] == NOT_VALID_SUBSCRIBER_ID) {
-                emptyIndex = i;
-            }
-        }
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    if (pipe->isInitialized) {
+        return RPVC_ERR_STATE;
+    }
 
-        if (emptyIndex == (size_t)(-1)) {
-            return RPVC_ERR_OUT_OF_RANGE; // Should not happen due to earlier check
+    RPVC_SbMsgHandle_t *storage = config->storage;
+    bool fromPool = false;
+    if (storage == NULL) {
+        RPVC_Status_t status = RPVC_MEMORYPOOL_Allocate(config->depth * sizeof(RPVC_SbMsgHandle_t), (void**)&storage);
+        if (status != RPVC_OK) {
+            return status;
         }
+        fromPool = true;
+    }
 
-        entry->subscriberIds[emptyIndex] = subscriberId;
-        entry->count++;
+    releasePipeStorage(pipe);
+    configurePipe(pipe, storage, config->depth, config->overflowPolicy, fromPool);
+    pipe->isCreated = true;
+    return RPVC_OK;
+}
 
-        g_sbState.pipes[subscriberId].isInitialized = true;
-        return RPVC_OK;
+RPVC_Status_t RPVC_SB_GetPipeDropCount(RPVC_SbSubscriberId_t subscriberId, uint32_t *outDropCount)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
     }
-    else {
-        return RPVC_ERR_OUT_OF_RANGE;
+
+    if (!IsValidSubscriber(subscriberId) || outDropCount == NULL) {
+        return RPVC_ERR_INVALID_ARG;
     }
+
+    *outDropCount = RPVC_ATOMIC_LOAD(&g_sbState.pipes[subscriberId].dropCount);
+    return RPVC_OK;
 }
 
-RPVC_Status_t RPVC_SB_Unsubscribe(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId)
+RPVC_Status_t RPVC_SB_GetPipeFd(RPVC_SbSubscriberId_t subscriberId, int *outFd)
 {
     if (!g_sbState.isInitialized) {
         return RPVC_ERR_NOT_READY;
     }
 
-    if (!IsValidSubscriber(subscriberId) || !IsValidMessageId(messageId)) {
+    if (!IsValidSubscriber(subscriberId) || outFd == NULL) {
         return RPVC_ERR_INVALID_ARG;
     }
 
-    RPVC_SbRouteEntry_t *entry = &g_sbState.routes[messageId];
-    if (entry->count > 0) {
-        for (size_t i = 0; i < RPVC_SB_MAX_SUBSCRIBERS; i++) {
-            if (entry->subscriberIds[i] == subscriberId) {
-                //RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
-                entry->subscriberIds[i] = NOT_VALID_SUBSCRIBER_ID;
-                entry->count--;
-                return RPVC_OK;
-            }
+#if SB_USE_EVENTFD
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    int32_t fd = RPVC_ATOMIC_LOAD(&pipe->eventFd);
+    if (fd < 0) {
+        fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0) {
+            return RPVC_ERR_NO_RESOURCE;
+        }
+        RPVC_ATOMIC_STORE(&pipe->eventFd, fd);
+        // a publish that raced the install may have skipped the write
+        RPVC_ATOMIC_FENCE();
+        if (queuedInPipe(pipe) != 0) {
+            uint64_t one = 1;
+            (void)write(fd, &one, sizeof(one));
         }
     }
-    return RPVC_ERR_NOT_FOUND;
+    *outFd = fd;
+    return RPVC_OK;
+#else
+    return RPVC_ERR_CONFIG;
+#endif
 }
 
-static void addMessageToPipe(RPVC_SbPip_t *pipe, RPVC_SbMsgHandle_t messageHandle) 
+RPVC_Status_t RPVC_SB_BindShard(uint8_t shardId)
 {
-    size_t tailIndex = pipe->queue.tail;
-    pipe->queue.tail = (tailIndex + 1) % RPVC_SB_MAX_QUEUE_DEPTH;
-    pipe->queue.count++;
-    messageHandle->refCount++;
-    pipe->queue.buffer[tailIndex] = messageHandle;
+    if (shardId >= RPVC_SB_MAX_SHARDS) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+#if RPVC_SB_MAX_SHARDS > 1
+    t_shard = shardId;
+#endif
+    return RPVC_OK;
 }
 
-RPVC_Status_t RPVC_SB_Publish(RPVC_SbMsgHandle_t messageHandle)
+RPVC_Status_t RPVC_SB_SetPipeShard(RPVC_SbSubscriberId_t subscriberId, uint8_t shardId)
 {
     if (!g_sbState.isInitialized) {
         return RPVC_ERR_NOT_READY;
     }
 
-    if (!messageHandle) {
+    if (!IsValidSubscriber(subscriberId) || shardId >= RPVC_SB_MAX_SHARDS) {
         return RPVC_ERR_INVALID_ARG;
     }
-    
-    RPVC_SbMsgId_t msgId = messageHandle->messageId;
-    if (IsValidMessageId(msgId) == false) {
-        return RPVC_ERR_INVALID_ARG;
+
+    g_sbState.pipes[subscriberId].shard = shardId;
+    return RPVC_OK;
+}
+
+static bool readFilterClock(uint32_t *outNowUs)
+{
+    uint64_t nowUs = 0;
+    if (RPVC_OS_GetTimeMicroseconds(&nowUs) != RPVC_OK) {
+        return false;
+    }
+    *outNowUs = (uint32_t)nowUs;
+    return true;
+}
+
+// Turns every operator into a masked range test, so publish runs one
+// compare per field whatever the operator
+static bool compileMatch(const RPVC_SbContentMatch_t *match, RPVC_SbCompiledMatch_t *outCompiled)
+{
+    if ((match->width != 1 && match->width != 2 && match->width != 4) ||
+        (size_t)match->offset + match->width > RPVC_SB_MAX_PAYLOAD_SIZE) {
+        return false;
     }
 
-    bool publishedToAtLeastOne = false;
+    uint32_t max = match->width == 4 ? UINT32_MAX : (1U << (8U * match->width)) - 1U;
+    uint32_t value = match->value;
+    if (value > max && match->op != RPVC_SB_MATCH_ANY_BITS && match->op != RPVC_SB_MATCH_ALL_BITS) {
+        return false;
+    }
 
-    RPVC_SbRouteEntry_t *entry = &g_sbState.routes[msgId];
-    for (size_t j = 0; j < RPVC_SB_MAX_SUBSCRIBERS; j++) {
-        RPVC_SbSubscriberId_t subscriberId = entry->subscriberIds[j];
+    RPVC_SbCompiledMatch_t compiled = {match->offset, match->width, 0, max, 0, max};
+    switch (match->op) {
+        case RPVC_SB_MATCH_EQ: compiled.lo = value; compiled.hi = value; break;
+        case RPVC_SB_MATCH_NE: compiled.lo = value; compiled.hi = value; compiled.invert = 1; break;
+        case RPVC_SB_MATCH_LT: compiled.lo = value; compiled.invert = 1; break;    // not >= value
+        case RPVC_SB_MATCH_LE: compiled.hi = value; break;
+        case RPVC_SB_MATCH_GT: compiled.hi = value; compiled.invert = 1; break;    // not <= value
+        case RPVC_SB_MATCH_GE: compiled.lo = value; break;
+        case RPVC_SB_MATCH_ANY_BITS: compiled.mask = value & max; compiled.lo = 1; break;
+        case RPVC_SB_MATCH_ALL_BITS: compiled.mask = value & max; compiled.lo = value & max; compiled.hi = value & max; break;
+        default: return false;
+    }
+    *outCompiled = compiled;
+    return true;
+}
 
-        if (subscriberId != NOT_VALID_SUBSCRIBER_ID) {
-            RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+// A filtered subscription's filter, as named by the route
+static RPVC_SbRouteFilter_t *routeFilter(const RPVC_SbRoute_t *route, uint32_t subscriberId)
+{
+    return &g_sbState.filters[route->filterSlots[subscriberId]];
+}
 
-            if (pipe->isInitialized && pipe->queue.count < RPVC_SB_MAX_QUEUE_DEPTH) {
-                addMessageToPipe(pipe, messageHandle);
-                publishedToAtLeastOne = true;
+// Writes the filter into a slot neither snapshot names, then names it in the
+// spare snapshot; publishers keep using the old slot until the flip. A
+// subscription without options takes no slot.
+static RPVC_Status_t setRouteFilter(RPVC_SbRoute_t *route, RPVC_SbSubscriberId_t subscriberId, const RPVC_SbSubscribeOptions_t *options)
+{
+    RPVC_SbRouteFilter_t filter;
+    memset(&filter, 0, sizeof(filter));
+    filter.decimation = 1;
+    if (options != NULL) {
+        filter.decimation = options->decimation > 1 ? options->decimation : 1;
+        filter.minIntervalUs = options->minIntervalUs;
+
+        if (options->matchCount > RPVC_SB_MAX_CONTENT_MATCHES || (options->matchCount > 0 && options->matches == NULL)) {
+            return RPVC_ERR_INVALID_ARG;
+        }
+        for (uint8_t i = 0; i < options->matchCount; i++) {
+            RPVC_SbCompiledMatch_t *compiled = &filter.matches[i];
+            if (!compileMatch(&options->matches[i], compiled)) {
+                return RPVC_ERR_INVALID_ARG;
+            }
+            if (compiled->offset + compiled->width > filter.matchEnd) {
+                filter.matchEnd = (uint16_t)(compiled->offset + compiled->width);
             }
         }
+        filter.matchCount = options->matchCount;
+    }
+
+    // backdate the last delivery so the first message after subscribing goes through
+    if (filter.minIntervalUs != 0) {
+        uint32_t nowUs = 0;
+        if (!readFilterClock(&nowUs)) {
+            return RPVC_ERR_NOT_READY;
+        }
+        filter.lastDeliveryUs = nowUs - filter.minIntervalUs;
+    }
+
+    // only the change in progress moves the epoch
+    uint32_t *spareUsed = &g_sbState.filtersUsed[(g_sbState.routeEpoch & 1U) ^ 1U];
+    bool filtered = filter.decimation > 1 || filter.minIntervalUs != 0 || filter.matchCount > 0;
+    uint32_t slot = 0;
+    if (filtered) {
+        uint32_t freeSlots = ~(g_sbState.filtersUsed[0] | g_sbState.filtersUsed[1]) & SB_FILTER_SLOTS;
+        if (freeSlots == 0) {
+            return RPVC_ERR_NO_RESOURCE;
+        }
+        slot = RPVC_CTZ32(freeSlots);
+        g_sbState.filters[slot] = filter;
+    }
+
+    uint32_t pipeBit = 1U << subscriberId;
+    if ((route->filteredPipes & pipeBit) != 0) {
+        *spareUsed &= ~(1U << route->filterSlots[subscriberId]);
+    }
+    route->filteredPipes &= ~pipeBit;
+    route->rateLimitedPipes &= ~pipeBit;
+    if (filtered) {
+        *spareUsed |= 1U << slot;
+        route->filterSlots[subscriberId] = (uint8_t)slot;
+        route->filteredPipes |= pipeBit;
+    }
+    if (filter.minIntervalUs != 0) {
+        route->rateLimitedPipes |= pipeBit;
+    }
+    return RPVC_OK;
+}
+
+// For control calls waiting on a word another context holds for a few
+// stores: spin briefly, then sleep a tick between checks so the holder runs
+// even if it was preempted at a lower priority
+static void backOff(uint32_t *spins)
+{
+    if (*spins < SB_SPIN_LIMIT) {
+        (*spins)++;
+    }
+    else {
+        (void)RPVC_OS_TaskSleep(1);
+    }
+}
+
+// Serializes subscription changes and latch reconfiguration
+static void lockRouteWriter(void)
+{
+    uint32_t spins = 0;
+    while (!RPVC_ATOMIC_CAS(&g_sbState.routeWriter, 0U, 1U)) {
+        backOff(&spins);
+    }
+}
+
+static void unlockRouteWriter(void)
+{
+    RPVC_ATOMIC_STORE(&g_sbState.routeWriter, 0U);
+}
+
+// Starts a subscription change and returns the spare snapshot, filled from
+// the current one. Publishers that entered the spare before the last change
+// may still be routing through it: filters and copying handlers, never the
+// handlers themselves, so the wait is bounded by that work plus the ticks
+// slept while a preempted publisher gets to run again. Once they have left,
+// the slots only the spare named are free to fill.
+static RPVC_SbRoute_t *beginRouteChange(void)
+{
+    lockRouteWriter();
+
+    uint32_t current = RPVC_ATOMIC_LOAD(&g_sbState.routeEpoch) & 1U;
+    // pairs with the fences in enterRoutes
+    RPVC_ATOMIC_FENCE();
+    uint32_t spins = 0;
+    for (size_t shard = 0; shard < RPVC_SB_MAX_SHARDS; shard++) {
+        while (RPVC_ATOMIC_LOAD(&g_sbState.routeReaders[shard].count[current ^ 1U]) != 0) {
+            backOff(&spins);
+        }
+    }
+
+    memcpy(g_sbState.snapshots[current ^ 1U], g_sbState.snapshots[current], sizeof(g_sbState.snapshots[current]));
+    g_sbState.filtersUsed[current ^ 1U] = g_sbState.filtersUsed[current];
+    return g_sbState.snapshots[current ^ 1U];
+}
+
+// Publishes the spare snapshot, unless the change failed
+static void endRouteChange(bool commit)
+{
+    if (commit) {
+        RPVC_ATOMIC_STORE(&g_sbState.routeEpoch, g_sbState.routeEpoch + 1U);
     }
+    unlockRouteWriter();
+}
+
+static RPVC_Status_t addSubscription(RPVC_SbRouteEntry_t *entry, RPVC_SbRoute_t *route, RPVC_SbSubscriberId_t subscriberId, const RPVC_SbSubscribeOptions_t *options, bool *outAdded)
+{
+    *outAdded = false;
+    if (entry->count < RPVC_SB_MAX_SUBSCRIBERS) {
+        size_t emptyIndex = (size_t)(-1);
+        for (size_t i = 0; i < RPVC_SB_MAX_SUBSCRIBERS; i++) {
+            if (entry->subscriberIds[i] == subscriberId) {
+                return setRouteFilter(route, subscriberId, options); // Already subscribed
+            }
+
+            if (entry->subscriberIds[i] == NOT_VALID_SUBSCRIBER_ID) {
+                emptyIndex = i;
+            }
+        }
+
+        if (emptyIndex == (size_t)(-1)) {
+            return RPVC_ERR_OUT_OF_RANGE; // Should not happen due to earlier check
+        }
 
-    if (publishedToAtLeastOne) {
+        RPVC_Status_t status = setRouteFilter(route, subscriberId, options);
+        if (status != RPVC_OK) {
+            return status;
+        }
+        entry->subscriberIds[emptyIndex] = subscriberId;
+        entry->count++;
+        route->pipes |= 1U << subscriberId;
+        *outAdded = true;
         return RPVC_OK;
     }
     else {
@@ -208,96 +760,2315 @@ RPVC_Status_t RPVC_SB_Publish(RPVC_SbMsgHandle_t messageHandle)
     }
 }
 
-static void grabAndPopMessageFromPipe(RPVC_SbPip_t *pipe, RPVC_SbMsgHandle_t *outMessageHandle) 
+static RPVC_Status_t removeSubscription(RPVC_SbRouteEntry_t *entry, RPVC_SbRoute_t *route, RPVC_SbSubscriberId_t subscriberId)
 {
-    size_t headIndex = pipe->queue.head;
-    pipe->queue.head = (headIndex + 1) % RPVC_SB_MAX_QUEUE_DEPTH;
-    pipe->queue.count--;
+    if (entry->count > 0) {
+        for (size_t i = 0; i < RPVC_SB_MAX_SUBSCRIBERS; i++) {
+            if (entry->subscriberIds[i] == subscriberId) {
+                (void)setRouteFilter(route, subscriberId, NULL);
+                entry->subscriberIds[i] = NOT_VALID_SUBSCRIBER_ID;
+                entry->count--;
+                route->pipes &= ~(1U << subscriberId);
+                return RPVC_OK;
+            }
+        }
+    }
+    return RPVC_ERR_NOT_FOUND;
+}
 
-    RPVC_SbMsgHandle_t message = pipe->queue.buffer[headIndex];
-    message->refCount--;
-    *outMessageHandle = message;
+RPVC_Status_t RPVC_SB_Subscribe(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId)
+{
+    return RPVC_SB_SubscribeWithOptions(subscriberId, messageId, NULL);
 }
 
-RPVC_Status_t RPVC_SB_Receive(RPVC_SbSubscriberId_t subscriberId, uint8_t *outBuffer, size_t bufferSize)
+RPVC_Status_t RPVC_SB_SubscribeWithOptions(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId, const RPVC_SbSubscribeOptions_t *options)
 {
     if (!g_sbState.isInitialized) {
         return RPVC_ERR_NOT_READY;
     }
 
-    if (!IsValidSubscriber(subscriberId) || outBuffer == NULL || bufferSize == 0) {
+    if (!IsValidSubscriber(subscriberId) || !IsValidMessageId(messageId)) {
         return RPVC_ERR_INVALID_ARG;
     }
 
-    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
-    if (!pipe->isInitialized || pipe->queue.count == 0) {
-        return RPVC_ERR_OUT_OF_RANGE;
+    RPVC_SbRouteEntry_t *entry = &g_sbState.routes[messageId];
+    bool added = false;
+    RPVC_SbRoute_t *routes = beginRouteChange();
+    RPVC_Status_t status = addSubscription(entry, &routes[messageId], subscriberId, options, &added);
+    if (added) {
+        g_sbState.pipes[subscriberId].isInitialized = true;
+        handOffLatched(entry, subscriberId);
     }
-    RPVC_SbMsgHandle_t messageHandle;
-    grabAndPopMessageFromPipe(pipe, &messageHandle);
-    size_t copySize = messageHandle->len < bufferSize ? messageHandle->len : bufferSize;
-    memcpy(outBuffer, messageHandle->payload, copySize);
-    return RPVC_OK;
+    endRouteChange(status == RPVC_OK);
+    return status;
 }
 
-RPVC_Status_t RPVC_SB_Flush(RPVC_SbSubscriberId_t subscriberId)
+RPVC_Status_t RPVC_SB_Unsubscribe(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId)
 {
     if (!g_sbState.isInitialized) {
         return RPVC_ERR_NOT_READY;
     }
 
-    if (!IsValidSubscriber(subscriberId)) {
+    if (!IsValidSubscriber(subscriberId) || !IsValidMessageId(messageId)) {
         return RPVC_ERR_INVALID_ARG;
     }
 
-    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
-    pipe->queue.head = 0;
-    pipe->queue.tail = 0;
-    pipe->queue.count = 0;
-    pipe->isInitialized = false;
-    
-    return RPVC_OK;
+    RPVC_SbRoute_t *routes = beginRouteChange();
+    RPVC_Status_t status = removeSubscription(&g_sbState.routes[messageId], &routes[messageId], subscriberId);
+    endRouteChange(status == RPVC_OK);
+    return status;
 }
 
-RPVC_Status_t RPVC_SB_CreateMessage(RPVC_SbMsgId_t messageId, const uint8_t *messageData, size_t messageSize, RPVC_SbMsgHandle_t *outMessageHandle)
+RPVC_Status_t RPVC_SB_SubscribeCallback(RPVC_SbMsgId_t messageId, RPVC_SbCallback_t callback, void *context)
 {
     if (!g_sbState.isInitialized) {
         return RPVC_ERR_NOT_READY;
     }
 
-    if (!IsValidMessageId(messageId) || !outMessageHandle || !messageData) {
+    if (!IsValidMessageId(messageId) || callback == NULL) {
         return RPVC_ERR_INVALID_ARG;
     }
 
-    RPVC_SbMsgHandle_t newmessage = NULL;
-    RPVC_Status_t status = RPVC_MEMORYPOOL_Allocate(sizeof(RPVC_SbMsg_t), (void**)&newmessage);
-    if (status != RPVC_OK) {
-        return status;
+    RPVC_SbCallbackEntry_t *table = g_sbState.routes[messageId].callbacks;
+    RPVC_SbRoute_t *route = &beginRouteChange()[messageId];
+    uint32_t live = route->callbackMask;
+    while (live != 0) {
+        uint32_t slot = RPVC_CTZ32(live);
+        live &= live - 1;
+        if (table[slot].callback == callback && table[slot].context == context) {
+            endRouteChange(false);
+            return RPVC_OK; // Already subscribed
+        }
     }
 
-    size_t trueSize = messageSize > RPVC_SB_MAX_PAYLOAD_SIZE ? RPVC_SB_MAX_PAYLOAD_SIZE : messageSize;
-    newmessage->messageId = messageId;
-    memcpy(newmessage->payload, messageData, trueSize);
-    newmessage->len = trueSize;
-    newmessage->refCount = 0;
-    *outMessageHandle = newmessage;
+    uint32_t freeSlots = ~(uint32_t)route->callbackMask & SB_CALLBACK_SLOTS;
+    if (freeSlots == 0) {
+        endRouteChange(false);
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    // publishers may be copying the slots in use; a free one is named by no
+    // snapshot they can still be in
+    uint32_t slot = RPVC_CTZ32(freeSlots);
+    table[slot].callback = callback;
+    table[slot].context = context;
+    route->callbackMask |= (uint8_t)(1U << slot);
+    endRouteChange(true);
     return RPVC_OK;
 }
 
-RPVC_Status_t RPVC_SB_ReleaseMessage(RPVC_SbMsgHandle_t messageHandle)
+RPVC_Status_t RPVC_SB_UnsubscribeCallback(RPVC_SbMsgId_t messageId, RPVC_SbCallback_t callback, void *context)
 {
     if (!g_sbState.isInitialized) {
         return RPVC_ERR_NOT_READY;
     }
 
-    if (!messageHandle) {
+    if (!IsValidMessageId(messageId) || callback == NULL) {
         return RPVC_ERR_INVALID_ARG;
     }
 
-    if (messageHandle->refCount > 0) { // some pipes are still using it
-        return RPVC_ERR_STATE;
+    const RPVC_SbCallbackEntry_t *table = g_sbState.routes[messageId].callbacks;
+    RPVC_SbRoute_t *route = &beginRouteChange()[messageId];
+    bool found = false;
+    uint32_t live = route->callbackMask;
+    while (live != 0 && !found) {
+        uint32_t slot = RPVC_CTZ32(live);
+        live &= live - 1;
+        if (table[slot].callback == callback && table[slot].context == context) {
+            // left as it is until no publisher can be copying it
+            route->callbackMask &= (uint8_t)~(1U << slot);
+            found = true;
+        }
     }
-    else {
-        return RPVC_MEMORYPOOL_Free((void*)messageHandle);
+    endRouteChange(found);
+    return found ? RPVC_OK : RPVC_ERR_NOT_FOUND;
+}
+
+RPVC_Status_t RPVC_SB_SetTopicTtl(RPVC_SbMsgId_t messageId, uint32_t ttlUs)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
     }
+
+    if (!IsValidMessageId(messageId) || ttlUs > RPVC_SB_MAX_TTL_US) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    g_sbState.routes[messageId].ttlUs = ttlUs;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_SetTopicPriority(RPVC_SbMsgId_t messageId, uint8_t priority)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || priority >= RPVC_SB_PRIORITY_LANES) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    g_sbState.routes[messageId].priority = priority;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_SetTopicLatch(RPVC_SbMsgId_t messageId, bool enable)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId)) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    // no subscriber is taking a reference while the writer lock is held
+    RPVC_SbRouteEntry_t *entry = &g_sbState.routes[messageId];
+    lockRouteWriter();
+    entry->isLatched = enable;
+    if (!enable) {
+        // a publisher that latches after this sees the latch disabled
+        uint32_t spins = 0;
+        while (!RPVC_ATOMIC_CAS(&entry->latchWriter, 0U, 1U)) {
+            backOff(&spins);
+        }
+        RPVC_SbMsgHandle_t released[SB_LATCH_SLOTS];
+        memcpy(released, entry->latchSlots, sizeof(released));
+        memset(entry->latchSlots, 0, sizeof(entry->latchSlots));
+        RPVC_ATOMIC_STORE(&entry->latchCurrent, 0U);
+        RPVC_ATOMIC_STORE(&entry->latchWriter, 0U);
+        for (uint32_t slot = 0; slot < SB_LATCH_SLOTS; slot++) {
+            if (released[slot] != NULL) {
+                dropReference(released[slot]);
+            }
+        }
+    }
+    unlockRouteWriter();
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_CreateLatest(RPVC_SbMsgId_t messageId, size_t maxSize)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || maxSize == 0 || maxSize > RPVC_SB_MAX_PAYLOAD_SIZE) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbLatestValue_t *latest = &g_sbState.routes[messageId].latest;
+    if (latest->capacity != 0) {
+        return RPVC_ERR_STATE;
+    }
+
+    RPVC_SbLatestSlot_t *slots[2] = {NULL, NULL};
+    for (size_t i = 0; i < 2; i++) {
+        RPVC_Status_t status = RPVC_MEMORYPOOL_Allocate(sizeof(RPVC_SbLatestSlot_t) + maxSize, (void**)&slots[i]);
+        if (status != RPVC_OK) {
+            if (i == 1) {
+                (void)RPVC_MEMORYPOOL_Free(slots[0]);
+            }
+            return status;
+        }
+        slots[i]->len = 0;
+    }
+
+    latest->slots[0] = slots[0];
+    latest->slots[1] = slots[1];
+    RPVC_ATOMIC_STORE(&latest->sequence, 0U);
+    RPVC_ATOMIC_STORE(&latest->capacity, (uint32_t)maxSize); // publishers start writing from here
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_ReadLatest(RPVC_SbMsgId_t messageId, uint8_t *outBuffer, size_t bufferSize, size_t *outSize, uint32_t *outSequence)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || outBuffer == NULL || bufferSize == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbLatestValue_t *latest = &g_sbState.routes[messageId].latest;
+    if (RPVC_ATOMIC_LOAD(&latest->capacity) == 0) {
+        return RPVC_ERR_NOT_FOUND;
+    }
+
+    while (true) {
+        uint32_t sequence = RPVC_ATOMIC_LOAD(&latest->sequence);
+        uint32_t completed = sequence / 2U;
+        if (completed == 0) {
+            return RPVC_ERR_OUT_OF_RANGE; // nothing published yet
+        }
+
+        const RPVC_SbLatestSlot_t *slot = latest->slots[completed & 1U];
+        size_t len = slot->len;
+        size_t copySize = len < bufferSize ? len : bufferSize;
+        memcpy(outBuffer, slot->data, copySize);
+
+        // the copy is good unless a writer has since started on the same slot
+        RPVC_ATOMIC_FENCE();
+        if ((uint32_t)(RPVC_ATOMIC_LOAD(&latest->sequence) - completed * 2U) <= 2U) {
+            if (outSize != NULL) {
+                *outSize = len;
+            }
+            if (outSequence != NULL) {
+                *outSequence = completed;
+            }
+            return RPVC_OK;
+        }
+    }
+}
+
+RPVC_Status_t RPVC_SB_CreateBroadcast(RPVC_SbMsgId_t messageId, const RPVC_SbBroadcastConfig_t *config)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || config == NULL || config->depth == 0 ||
+        config->depth > RPVC_SB_MAX_PIPE_DEPTH || (config->depth & (config->depth - 1U)) != 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbBroadcast_t *broadcast = &g_sbState.routes[messageId].broadcast;
+    if (broadcast->ring != NULL) {
+        return RPVC_ERR_STATE;
+    }
+
+    RPVC_SbMsgHandle_t *ring = config->storage;
+    bool fromPool = false;
+    if (ring == NULL) {
+        RPVC_Status_t status = RPVC_MEMORYPOOL_Allocate(config->depth * sizeof(RPVC_SbMsgHandle_t), (void**)&ring);
+        if (status != RPVC_OK) {
+            return status;
+        }
+        fromPool = true;
+    }
+    memset(ring, 0, config->depth * sizeof(RPVC_SbMsgHandle_t));
+
+    broadcast->mask = config->depth - 1U;
+    broadcast->tail = 0;
+    broadcast->gate = 0;
+    broadcast->readers = 0;
+    broadcast->storageFromPool = fromPool;
+    broadcast->ring = ring;
+    RPVC_ATOMIC_STORE(&broadcast->ready, 1U); // publishers start writing from here
+    return RPVC_OK;
+}
+
+static bool updateReaders(RPVC_SbBroadcast_t *broadcast, uint32_t readerBit, bool join)
+{
+    while (true) {
+        uint32_t readers = RPVC_ATOMIC_LOAD(&broadcast->readers);
+        if (((readers & readerBit) != 0) == join) {
+            return false;
+        }
+        if (RPVC_ATOMIC_CAS(&broadcast->readers, readers, readers ^ readerBit)) {
+            return true;
+        }
+    }
+}
+
+static RPVC_Status_t getBroadcast(RPVC_SbMsgId_t messageId, uint8_t readerId, RPVC_SbBroadcast_t **outBroadcast)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || readerId >= RPVC_SB_MAX_BROADCAST_READERS) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outBroadcast = &g_sbState.routes[messageId].broadcast;
+    return RPVC_ATOMIC_LOAD(&(*outBroadcast)->ready) != 0 ? RPVC_OK : RPVC_ERR_NOT_FOUND;
+}
+
+RPVC_Status_t RPVC_SB_JoinBroadcast(RPVC_SbMsgId_t messageId, uint8_t readerId)
+{
+    RPVC_SbBroadcast_t *broadcast = NULL;
+    RPVC_Status_t status = getBroadcast(messageId, readerId, &broadcast);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    if ((RPVC_ATOMIC_LOAD(&broadcast->readers) & (1U << readerId)) != 0) {
+        return RPVC_ERR_STATE;
+    }
+
+    // the cursor is in place before the publisher can see the reader, and
+    // starts at the tail, which is never behind the publisher's cached gate
+    RPVC_ATOMIC_STORE(&broadcast->cursors[readerId], RPVC_ATOMIC_LOAD(&broadcast->tail));
+    return updateReaders(broadcast, 1U << readerId, true) ? RPVC_OK : RPVC_ERR_STATE;
+}
+
+RPVC_Status_t RPVC_SB_LeaveBroadcast(RPVC_SbMsgId_t messageId, uint8_t readerId)
+{
+    RPVC_SbBroadcast_t *broadcast = NULL;
+    RPVC_Status_t status = getBroadcast(messageId, readerId, &broadcast);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    return updateReaders(broadcast, 1U << readerId, false) ? RPVC_OK : RPVC_ERR_NOT_FOUND;
+}
+
+// Messages between the reader's cursor and the tail; the slots stay put
+// until the cursor moves past them
+static uint32_t broadcastPending(RPVC_SbBroadcast_t *broadcast, uint8_t readerId, uint32_t *outCursor)
+{
+    *outCursor = broadcast->cursors[readerId]; // only this reader moves it
+    return RPVC_ATOMIC_LOAD(&broadcast->tail) - *outCursor;
+}
+
+RPVC_Status_t RPVC_SB_ReceiveBroadcast(RPVC_SbMsgId_t messageId, uint8_t readerId, uint8_t *outBuffer, size_t bufferSize)
+{
+    RPVC_SbBroadcast_t *broadcast = NULL;
+    RPVC_Status_t status = getBroadcast(messageId, readerId, &broadcast);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    if (outBuffer == NULL || bufferSize == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    uint32_t cursor = 0;
+    if ((RPVC_ATOMIC_LOAD(&broadcast->readers) & (1U << readerId)) == 0) {
+        return RPVC_ERR_STATE;
+    }
+    if (broadcastPending(broadcast, readerId, &cursor) == 0) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    RPVC_SbMsgHandle_t message = broadcast->ring[cursor & broadcast->mask];
+    size_t copySize = message->len < bufferSize ? message->len : bufferSize;
+    memcpy(outBuffer, message->payload, copySize);
+    RPVC_ATOMIC_STORE(&broadcast->cursors[readerId], cursor + 1U); // hands the slot back to the publisher
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_ReceiveBroadcastBatch(RPVC_SbMsgId_t messageId, uint8_t readerId, RPVC_SbMsgHandle_t *outHandles, size_t maxHandles, size_t *outCount)
+{
+    RPVC_SbBroadcast_t *broadcast = NULL;
+    RPVC_Status_t status = getBroadcast(messageId, readerId, &broadcast);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    if (outHandles == NULL || maxHandles == 0 || outCount == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outCount = 0;
+    uint32_t cursor = 0;
+    if ((RPVC_ATOMIC_LOAD(&broadcast->readers) & (1U << readerId)) == 0) {
+        return RPVC_ERR_STATE;
+    }
+    uint32_t pending = broadcastPending(broadcast, readerId, &cursor);
+    if (pending == 0) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    // the caller gets references of its own; the ring keeps its one
+    uint32_t taken = pending < maxHandles ? pending : (uint32_t)maxHandles;
+    for (uint32_t i = 0; i < taken; i++) {
+        RPVC_SbMsgHandle_t message = broadcast->ring[(cursor + i) & broadcast->mask];
+        RPVC_ATOMIC_FETCH_ADD(&message->refCount, 1);
+        outHandles[i] = message;
+    }
+    RPVC_ATOMIC_STORE(&broadcast->cursors[readerId], cursor + taken);
+    *outCount = taken;
+    return RPVC_OK;
+}
+
+#if RPVC_SB_MESSAGE_SLAB_SLOTS > 0
+static bool takeSlabSlot(void **outBlock)
+{
+    for (size_t word = 0; word < SB_SLAB_WORDS; word++) {
+        uint32_t used = RPVC_ATOMIC_LOAD(&g_sbState.slabUsed[word]);
+        while (used != UINT32_MAX) {
+            uint32_t bit = RPVC_CTZ32(~used);
+            if (RPVC_ATOMIC_CAS(&g_sbState.slabUsed[word], used, used | (1U << bit))) {
+                *outBlock = &g_sbState.slab[word * 32 + bit];
+                return true;
+            }
+            used = RPVC_ATOMIC_LOAD(&g_sbState.slabUsed[word]);
+        }
+    }
+    return false;
+}
+#endif
+
+// Messages up to half a cache line take the best-fitting pool class, which
+// wastes less than a slot; larger ones that fit a slab slot take one while
+// any is free. Each falls back to the other.
+static RPVC_Status_t allocateMessageBlock(size_t size, void **outBlock)
+{
+#if RPVC_SB_MESSAGE_SLAB_SLOTS > 0
+    if (size <= SB_CACHE_LINE / 2) {
+        RPVC_Status_t status = RPVC_MEMORYPOOL_Allocate(size, outBlock);
+        return (status == RPVC_OK || !takeSlabSlot(outBlock)) ? status : RPVC_OK;
+    }
+    if (size <= RPVC_SB_MESSAGE_SLAB_SLOT_SIZE && takeSlabSlot(outBlock)) {
+        return RPVC_OK;
+    }
+#endif
+    return RPVC_MEMORYPOOL_Allocate(size, outBlock);
+}
+
+static void freeMessageBlock(RPVC_SbMsgHandle_t messageHandle)
+{
+#if RPVC_SB_MESSAGE_SLAB_SLOTS > 0
+    uintptr_t offset = (uintptr_t)messageHandle - (uintptr_t)g_sbState.slab;
+    if (offset < sizeof(g_sbState.slab)) {
+        size_t slot = offset / sizeof(RPVC_SbSlabSlot_t);
+        RPVC_ATOMIC_FETCH_SUB(&g_sbState.slabUsed[slot / 32], 1U << (slot % 32)); // the bit is set
+        return;
+    }
+#endif
+    (void)RPVC_MEMORYPOOL_Free((void*)messageHandle);
+}
+
+static void dropReference(RPVC_SbMsgHandle_t messageHandle)
+{
+    if (RPVC_ATOMIC_FETCH_SUB(&messageHandle->refCount, 1) == 1) {
+        freeMessageBlock(messageHandle);
+    }
+}
+
+static void notifyPipe(RPVC_SbPip_t *pipe)
+{
+    // pairs with the fence in RPVC_SB_ReceiveTimeout after the semaphore is installed
+    RPVC_ATOMIC_FENCE();
+    RPVC_OS_Sem *sem = pipe->dataSem;
+    if (sem != NULL) {
+        (void)RPVC_OS_SemSignal(sem);
+    }
+#if SB_USE_EVENTFD
+    int32_t fd = RPVC_ATOMIC_LOAD(&pipe->eventFd);
+    if (fd >= 0) {
+        uint64_t one = 1;
+        (void)write(fd, &one, sizeof(one));
+    }
+#endif
+}
+
+static uint32_t advanceIndex(const RPVC_SbQueue_t *queue, uint32_t index, uint32_t steps)
+{
+    uint32_t untilWrap = queue->indexLimit - index;
+    return steps >= untilWrap ? steps - untilWrap : index + steps;
+}
+
+static uint32_t queuedBetween(const RPVC_SbQueue_t *queue, uint32_t head, uint32_t tail)
+{
+    return tail >= head ? tail - head : tail + (queue->indexLimit - head);
+}
+
+static uint32_t freeSlotsOf(RPVC_SbQueue_t *queue)
+{
+    // only the publisher moves tail, so it reads its own copy without ordering
+    return queue->depth - queuedBetween(queue, RPVC_ATOMIC_LOAD(&queue->head), queue->tail);
+}
+
+// Claims up to maxCount of the oldest messages into outHandles; the claimer
+// then owns the pipe's references. Receivers and drop-oldest publishers race
+// here, so the slots are read first and only kept if the head CAS wins.
+static uint32_t claimOldest(RPVC_SbQueue_t *queue, RPVC_SbMsgHandle_t *outHandles, uint32_t maxCount)
+{
+    while (true) {
+        uint32_t head = RPVC_ATOMIC_LOAD(&queue->head);
+        uint32_t queued = queuedBetween(queue, head, RPVC_ATOMIC_LOAD(&queue->tail));
+        uint32_t taken = queued < maxCount ? queued : maxCount;
+        if (taken == 0) {
+            return 0;
+        }
+
+        uint32_t index = head;
+        for (uint32_t i = 0; i < taken; i++) {
+            outHandles[i] = queue->buffer[index % queue->depth];
+            index = advanceIndex(queue, index, 1);
+        }
+        if (RPVC_ATOMIC_CAS(&queue->head, head, index)) {
+            RPVC_ATOMIC_FETCH_SUB(&queue->count, taken);
+            return taken;
+        }
+    }
+}
+
+static RPVC_SbQueue_t *laneQueue(RPVC_SbPip_t *pipe, uint8_t priority)
+{
+#if RPVC_SB_PRIORITY_LANES > 1
+    if (priority != RPVC_SB_PRIORITY_NORMAL) {
+        return &pipe->urgentLanes[priority - 1U];
+    }
+#else
+    (void)priority;
+#endif
+    return &pipe->queue;
+}
+
+#if RPVC_SB_PRIORITY_LANES > 1
+static void setPendingLane(RPVC_SbPip_t *pipe, uint32_t laneBit)
+{
+    uint32_t pending = RPVC_ATOMIC_LOAD(&pipe->pendingLanes);
+    while ((pending & laneBit) == 0 && !RPVC_ATOMIC_CAS(&pipe->pendingLanes, pending, pending | laneBit)) {
+        pending = RPVC_ATOMIC_LOAD(&pipe->pendingLanes);
+    }
+}
+
+// Receiver side, once a lane looked empty. A publish that raced the clear
+// either sees the lane empty and sets the bit itself, or is seen here.
+static void clearPendingLane(RPVC_SbPip_t *pipe, uint32_t laneBit, const RPVC_SbQueue_t *queue)
+{
+    uint32_t pending = RPVC_ATOMIC_LOAD(&pipe->pendingLanes);
+    while ((pending & laneBit) != 0 && !RPVC_ATOMIC_CAS(&pipe->pendingLanes, pending, pending & ~laneBit)) {
+        pending = RPVC_ATOMIC_LOAD(&pipe->pendingLanes);
+    }
+    RPVC_ATOMIC_FENCE();
+    if (RPVC_ATOMIC_LOAD(&queue->head) != RPVC_ATOMIC_LOAD(&queue->tail)) {
+        setPendingLane(pipe, laneBit);
+    }
+}
+#endif
+
+// Claims the oldest messages of the most urgent non-empty lanes first
+static uint32_t claimByPriority(RPVC_SbPip_t *pipe, RPVC_SbMsgHandle_t *outHandles, uint32_t maxCount)
+{
+#if RPVC_SB_PRIORITY_LANES > 1
+    uint32_t claimed = 0;
+    uint32_t pending = RPVC_ATOMIC_LOAD(&pipe->pendingLanes);
+    while (pending != 0 && claimed < maxCount) {
+        uint8_t priority = (uint8_t)(RPVC_SB_PRIORITY_LANES - 1U - RPVC_CTZ32(pending));
+        pending &= pending - 1;
+        RPVC_SbQueue_t *queue = laneQueue(pipe, priority);
+        claimed += claimOldest(queue, outHandles + claimed, maxCount - claimed);
+        if (claimed < maxCount) {
+            clearPendingLane(pipe, SB_LANE_BIT(priority), queue);
+        }
+    }
+    return claimed;
+#else
+    return claimOldest(&pipe->queue, outHandles, maxCount);
+#endif
+}
+
+// Messages waiting in every lane of a pipe
+static uint32_t queuedInPipe(RPVC_SbPip_t *pipe)
+{
+    uint32_t queued = 0;
+    for (uint32_t priority = 0; priority < RPVC_SB_PRIORITY_LANES; priority++) {
+        RPVC_SbQueue_t *queue = laneQueue(pipe, (uint8_t)priority);
+        // head first: the tail read afterwards can only be further along
+        uint32_t head = RPVC_ATOMIC_LOAD(&queue->head);
+        uint32_t depth = queuedBetween(queue, head, RPVC_ATOMIC_LOAD(&queue->tail));
+        queued += depth < queue->depth ? depth : queue->depth;
+    }
+    return queued + (RPVC_ATOMIC_LOAD(&pipe->latchTail) - RPVC_ATOMIC_LOAD(&pipe->latchHead));
+}
+
+static void evictOldest(RPVC_SbPip_t *pipe, RPVC_SbQueue_t *queue)
+{
+    RPVC_SbMsgHandle_t oldest;
+    if (claimOldest(queue, &oldest, 1) == 1) {
+        RPVC_ATOMIC_FETCH_ADD(&g_sbState.routes[oldest->messageId].stats.droppedFull, 1);
+        dropReference(oldest);
+        RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+    }
+}
+
+// Makes staged slots of one lane visible to the receiver in one step
+static void commitToPipe(RPVC_SbPip_t *pipe, uint8_t priority, uint32_t newTail, uint32_t added)
+{
+    RPVC_SbQueue_t *queue = laneQueue(pipe, priority);
+    RPVC_ATOMIC_STORE(&queue->tail, newTail);
+
+    uint32_t queued = queuedBetween(queue, RPVC_ATOMIC_LOAD(&queue->head), newTail);
+    if (queued > pipe->peakDepth) {
+        RPVC_ATOMIC_STORE(&pipe->peakDepth, queued);
+    }
+
+    // only the empty -> non-empty edge marks the lane and wakes a blocked receiver
+    if (RPVC_ATOMIC_FETCH_ADD(&queue->count, added) == 0) {
+#if RPVC_SB_PRIORITY_LANES > 1
+        setPendingLane(pipe, SB_LANE_BIT(priority));
+#endif
+        notifyPipe(pipe);
+    }
+}
+
+static void addMessageToPipe(RPVC_SbPip_t *pipe, RPVC_SbMsgHandle_t messageHandle) 
+{
+    RPVC_SbQueue_t *queue = laneQueue(pipe, messageHandle->priority);
+    uint32_t tail = queue->tail;
+    RPVC_ATOMIC_FETCH_ADD(&messageHandle->refCount, 1);
+    queue->buffer[tail % queue->depth] = messageHandle;
+    commitToPipe(pipe, messageHandle->priority, advanceIndex(queue, tail, 1), 1);
+}
+
+// Lets the receiver know a publisher is waiting for room (see returnCredit)
+static void markStarved(RPVC_SbPip_t *pipe)
+{
+    if (RPVC_ATOMIC_LOAD(&pipe->starved) == 0) {
+        RPVC_ATOMIC_STORE(&pipe->starved, 1U);
+    }
+}
+
+// Pipes owned by another shard are never written directly
+static bool isRemotePipe(const RPVC_SbPip_t *pipe)
+{
+#if RPVC_SB_MAX_SHARDS > 1
+    return pipe->shard != t_shard;
+#else
+    (void)pipe;
+    return false;
+#endif
+}
+
+// Hands a copy to the shard that owns the pipe; a full mailbox counts as a drop
+static uint32_t postToOwner(RPVC_SbSubscriberId_t subscriberId, RPVC_SbRouteEntry_t *entry, RPVC_SbMsgHandle_t messageHandle)
+{
+#if RPVC_SB_MAX_SHARDS > 1
+    RPVC_SbMailbox_t *mailbox = &g_sbState.mailboxes[t_shard][subscriberId];
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    uint32_t tail = mailbox->tail;
+    if (tail - RPVC_ATOMIC_LOAD(&mailbox->head) == RPVC_SB_SHARD_MAILBOX_DEPTH) {
+        RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+        markStarved(pipe);
+        RPVC_ATOMIC_FETCH_ADD(&entry->stats.droppedFull, 1);
+        return 0;
+    }
+
+    RPVC_ATOMIC_FETCH_ADD(&messageHandle->refCount, 1);
+    mailbox->slots[tail & SB_MAILBOX_MASK] = messageHandle;
+    RPVC_ATOMIC_STORE(&mailbox->tail, tail + 1);
+    // wakes a receiver blocked on the pipe, which drains the mailbox
+    if (RPVC_ATOMIC_FETCH_ADD(&mailbox->count, 1) == 0) {
+        notifyPipe(pipe);
+    }
+    return 1;
+#else
+    (void)subscriberId;
+    (void)entry;
+    (void)messageHandle;
+    return 0;
+#endif
+}
+
+// Takes latched messages handed to the pipe, oldest first
+static uint32_t claimLatched(RPVC_SbPip_t *pipe, RPVC_SbMsgHandle_t *outHandles, uint32_t maxCount)
+{
+    uint32_t claimed = 0;
+    while (claimed < maxCount) {
+        uint32_t head = RPVC_ATOMIC_LOAD(&pipe->latchHead);
+        if (head == RPVC_ATOMIC_LOAD(&pipe->latchTail)) {
+            break;
+        }
+        // the slot is not reused before head moves past it
+        RPVC_SbMsgHandle_t message = pipe->latchHandoff[head & SB_LATCH_MASK];
+        if (RPVC_ATOMIC_CAS(&pipe->latchHead, head, head + 1U)) {
+            outHandles[claimed++] = message;
+        }
+    }
+    return claimed;
+}
+
+// Queues one message on a local pipe under its overflow policy; returns 1 if queued
+static uint32_t queueToPipe(RPVC_SbPip_t *pipe, RPVC_SbRouteEntry_t *entry, RPVC_SbMsgHandle_t messageHandle)
+{
+    RPVC_SbQueue_t *queue = laneQueue(pipe, messageHandle->priority);
+    if (freeSlotsOf(queue) == 0) {
+        if (pipe->overflowPolicy != RPVC_SB_OVERFLOW_DROP_OLDEST) {
+            RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+            markStarved(pipe);
+            RPVC_ATOMIC_FETCH_ADD(&entry->stats.droppedFull, 1);
+            return 0;
+        }
+        evictOldest(pipe, queue);
+    }
+    addMessageToPipe(pipe, messageHandle);
+    return 1;
+}
+
+// Run by a producer before it queues to a local pipe: a latched message
+// handed over before the producer's route took in the pipe goes first. It is
+// written at the shared tail, so never while the producer has slots staged.
+static void admitLatched(RPVC_SbPip_t *pipe)
+{
+    RPVC_SbMsgHandle_t message;
+    while (claimLatched(pipe, &message, 1) == 1) {
+        (void)queueToPipe(pipe, &g_sbState.routes[message->messageId], message);
+        dropReference(message);
+    }
+}
+
+// One publish for one pipe, under the pipe's overflow policy; returns 1 if queued
+static uint32_t deliverToPipe(RPVC_SbSubscriberId_t subscriberId, RPVC_SbRouteEntry_t *entry, RPVC_SbMsgHandle_t messageHandle)
+{
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    if (isRemotePipe(pipe)) {
+        return postToOwner(subscriberId, entry, messageHandle);
+    }
+
+    admitLatched(pipe);
+    return queueToPipe(pipe, entry, messageHandle);
+}
+
+#if RPVC_SB_MAX_SHARDS > 1
+// Runs on the owner shard, which stays the pipe's only producer: each
+// mailbox goes into the pipe with one commit, under the pipe's overflow
+// policy (reject acts as drop-newest, the publish has already returned).
+static void drainMailboxes(RPVC_SbSubscriberId_t subscriberId, bool discard)
+{
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    for (uint32_t source = 0; source < RPVC_SB_MAX_SHARDS; source++) {
+        RPVC_SbMailbox_t *mailbox = &g_sbState.mailboxes[source][subscriberId];
+        uint32_t head = mailbox->head;
+        uint32_t tail = RPVC_ATOMIC_LOAD(&mailbox->tail);
+        while (head != tail) {
+            if (!discard) {
+                admitLatched(pipe);
+            }
+            uint32_t taken = tail - head;
+            uint32_t freeSlots = freeSlotsOf(&pipe->queue);
+            uint32_t stagedTail = pipe->queue.tail;
+            uint32_t staged = 0;
+            for (; head != tail; head++) {
+                RPVC_SbMsgHandle_t message = mailbox->slots[head & SB_MAILBOX_MASK];
+                if (message->priority != RPVC_SB_PRIORITY_NORMAL) {
+                    // urgent lanes are not staged; the queued copy takes its own
+                    // reference. Hand-offs were admitted above, before staging.
+                    if (!discard) {
+                        (void)queueToPipe(pipe, &g_sbState.routes[message->messageId], message);
+                    }
+                    dropReference(message);
+                    continue;
+                }
+                if (!discard && freeSlots == 0 && pipe->overflowPolicy == RPVC_SB_OVERFLOW_DROP_OLDEST) {
+                    if (staged > 0) {
+                        commitToPipe(pipe, RPVC_SB_PRIORITY_NORMAL, stagedTail, staged);
+                        staged = 0;
+                    }
+                    evictOldest(pipe, &pipe->queue);
+                    freeSlots = freeSlotsOf(&pipe->queue);
+                    stagedTail = pipe->queue.tail;
+                }
+
+                if (discard || freeSlots == 0) {
+                    if (!discard) {
+                        RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+                        RPVC_ATOMIC_FETCH_ADD(&g_sbState.routes[message->messageId].stats.droppedFull, 1);
+                    }
+                    dropReference(message);
+                    continue;
+                }
+
+                // the mailbox's reference moves to the pipe
+                pipe->queue.buffer[stagedTail % pipe->queue.depth] = message;
+                stagedTail = advanceIndex(&pipe->queue, stagedTail, 1);
+                freeSlots--;
+                staged++;
+            }
+
+            if (staged > 0) {
+                commitToPipe(pipe, RPVC_SB_PRIORITY_NORMAL, stagedTail, staged);
+            }
+            RPVC_ATOMIC_STORE(&mailbox->head, head);
+            // a post that raced this drain saw a non-zero count and did not
+            // notify, so look again until the count is seen to reach zero
+            if (RPVC_ATOMIC_FETCH_SUB(&mailbox->count, taken) == taken) {
+                break;
+            }
+            tail = RPVC_ATOMIC_LOAD(&mailbox->tail);
+        }
+    }
+}
+#endif
+
+// Opens a read section on the current snapshot. Until leaveRoutes the
+// snapshot, and the filter and handler slots it names, are not rewritten; no
+// handler may run inside, since a change it made would wait on the section
+// (see beginRouteChange). A change that commits while the count is taken
+// leaves the section holding both counts rather than retrying, so entering
+// never takes more than two read-modify-writes.
+static RPVC_SbRouteSection_t enterRoutes(void)
+{
+    RPVC_SbRouteSection_t section;
+#if RPVC_SB_MAX_SHARDS > 1
+    section.readers = &g_sbState.routeReaders[t_shard];
+#else
+    section.readers = &g_sbState.routeReaders[0];
+#endif
+    uint32_t epoch = RPVC_ATOMIC_LOAD(&g_sbState.routeEpoch);
+    RPVC_ATOMIC_FETCH_ADD(&section.readers->count[epoch & 1U], 1);
+    // pairs with the fence in beginRouteChange
+    RPVC_ATOMIC_FENCE();
+    section.epoch = RPVC_ATOMIC_LOAD(&g_sbState.routeEpoch);
+    section.held = 1U << (epoch & 1U);
+    if (((section.epoch ^ epoch) & 1U) != 0) {
+        // take the other count too: whichever copy the reload names is held
+        RPVC_ATOMIC_FETCH_ADD(&section.readers->count[section.epoch & 1U], 1);
+        RPVC_ATOMIC_FENCE();
+        section.epoch = RPVC_ATOMIC_LOAD(&g_sbState.routeEpoch);
+        section.held = 3U;
+    }
+    return section;
+}
+
+static void leaveRoutes(const RPVC_SbRouteSection_t *section)
+{
+    for (uint32_t copy = 0; copy < 2; copy++) {
+        if ((section->held & (1U << copy)) != 0) {
+            RPVC_ATOMIC_FETCH_SUB(&section->readers->count[copy], 1);
+        }
+    }
+}
+
+// Copy of messageId's route in the entered snapshot, with inactive pipes left out
+static RPVC_SbRoute_t routeIn(uint32_t epoch, RPVC_SbMsgId_t messageId)
+{
+    RPVC_SbRoute_t route = g_sbState.snapshots[epoch & 1U][messageId];
+    uint32_t pending = route.pipes;
+    while (pending != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(pending);
+        pending &= pending - 1;
+        if (!g_sbState.pipes[subscriberId].isInitialized) {
+            route.pipes &= ~(1U << subscriberId);
+        }
+    }
+    return route;
+}
+
+// The route alone, for callers that only look at its pipe sets
+static RPVC_SbRoute_t resolveRoute(RPVC_SbMsgId_t messageId)
+{
+    RPVC_SbRouteSection_t section = enterRoutes();
+    RPVC_SbRoute_t route = routeIn(section.epoch, messageId);
+    leaveRoutes(&section);
+    return route;
+}
+
+static bool matchesContent(const RPVC_SbRouteFilter_t *filter, RPVC_SbMsgHandle_t messageHandle)
+{
+    if (filter->matchCount == 0) {
+        return true;
+    }
+    if (messageHandle->len < filter->matchEnd) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < filter->matchCount; i++) {
+        const RPVC_SbCompiledMatch_t *match = &filter->matches[i];
+        const uint8_t *field = messageHandle->payload + match->offset;
+        uint32_t value;
+        if (match->width == 1) {
+            value = field[0];
+        }
+        else if (match->width == 2) {
+            uint16_t value16;
+            memcpy(&value16, field, sizeof(value16));
+            value = value16;
+        }
+        else {
+            memcpy(&value, field, sizeof(value));
+        }
+        bool inRange = (uint32_t)((value & match->mask) - match->lo) <= (uint32_t)(match->hi - match->lo);
+        if (inRange == (match->invert != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Content first: decimation and the rate limit only count matching messages
+static bool passFilter(RPVC_SbRouteFilter_t *filter, RPVC_SbMsgHandle_t messageHandle, uint32_t nowUs)
+{
+    if (!matchesContent(filter, messageHandle)) {
+        return false;
+    }
+
+    bool pass = filter->phase == 0;
+    filter->phase = (uint16_t)((filter->phase + 1U) % filter->decimation);
+    if (pass && filter->minIntervalUs != 0) {
+        pass = (uint32_t)(nowUs - filter->lastDeliveryUs) >= filter->minIntervalUs;
+        if (pass) {
+            filter->lastDeliveryUs = nowUs;
+        }
+    }
+    return pass;
+}
+
+// How many of the next occurrences messages passFilter would let through
+// when they all share one timestamp, without advancing the filter. Content
+// matches are not looked at, so with those it is an upper bound.
+static uint32_t countFilterPasses(const RPVC_SbRouteFilter_t *filter, uint32_t occurrences, uint32_t nowUs)
+{
+    uint32_t first = (uint32_t)(filter->decimation - filter->phase) % filter->decimation;
+    uint32_t passes = first < occurrences ? 1U + (occurrences - 1U - first) / filter->decimation : 0U;
+    if (passes > 0 && filter->minIntervalUs != 0) {
+        passes = (uint32_t)(nowUs - filter->lastDeliveryUs) >= filter->minIntervalUs ? 1U : 0U;
+    }
+    return passes;
+}
+
+// Messages out of the next occurrences that a subscription will take
+static uint32_t routeDemand(const RPVC_SbRoute_t *route, RPVC_SbSubscriberId_t subscriberId, uint32_t occurrences, uint32_t nowUs)
+{
+    if ((route->filteredPipes & (1U << subscriberId)) == 0) {
+        return occurrences;
+    }
+    return countFilterPasses(routeFilter(route, subscriberId), occurrences, nowUs);
+}
+
+// Handlers are copied inside the read section and called after leaving it
+static uint8_t copyCallbacks(const RPVC_SbRouteEntry_t *entry, const RPVC_SbRoute_t *route, RPVC_SbCallbackEntry_t *outCallbacks)
+{
+    uint8_t count = 0;
+    uint32_t pending = route->callbackMask;
+    while (pending != 0) {
+        uint32_t slot = RPVC_CTZ32(pending);
+        pending &= pending - 1;
+        outCallbacks[count++] = entry->callbacks[slot];
+    }
+    return count;
+}
+
+// Returns how many handlers were called
+static uint32_t invokeCallbacks(const RPVC_SbCallbackEntry_t *callbacks, uint8_t callbackCount, RPVC_SbMsgHandle_t messageHandle)
+{
+    for (uint8_t i = 0; i < callbackCount; i++) {
+        callbacks[i].callback(messageHandle->messageId, messageHandle->payload, messageHandle->len, callbacks[i].context);
+    }
+    return callbackCount;
+}
+
+// Overwrites the latest value; never waits. Concurrent writers do not queue
+// up: one that finds another write in progress leaves it the last word.
+static uint32_t writeLatest(RPVC_SbLatestValue_t *latest, RPVC_SbMsgHandle_t messageHandle)
+{
+    uint32_t capacity = RPVC_ATOMIC_LOAD(&latest->capacity);
+    if (capacity == 0) {
+        return 0;
+    }
+
+    uint32_t sequence = RPVC_ATOMIC_LOAD(&latest->sequence);
+    if ((sequence & 1U) != 0 || !RPVC_ATOMIC_CAS(&latest->sequence, sequence, sequence + 1U)) {
+        return 1;
+    }
+
+    RPVC_SbLatestSlot_t *slot = latest->slots[(sequence / 2U + 1U) & 1U];
+    uint16_t len = messageHandle->len < capacity ? messageHandle->len : (uint16_t)capacity;
+    slot->len = len;
+    memcpy(slot->data, messageHandle->payload, len);
+    RPVC_ATOMIC_STORE(&latest->sequence, sequence + 2U);
+    return 1;
+}
+
+// Appends to the broadcast ring once, whatever the number of readers. The
+// slowest cursor is only looked up again when the cached one says the ring
+// is full; if it still is, the message is dropped for every reader.
+static uint32_t publishBroadcast(RPVC_SbRouteEntry_t *entry, RPVC_SbMsgHandle_t messageHandle)
+{
+    RPVC_SbBroadcast_t *broadcast = &entry->broadcast;
+    uint32_t readers = RPVC_ATOMIC_LOAD(&broadcast->readers);
+    if (readers == 0 || RPVC_ATOMIC_LOAD(&broadcast->ready) == 0) {
+        return 0;
+    }
+
+    uint32_t tail = broadcast->tail;
+    if (tail - broadcast->gate > broadcast->mask) {
+        uint32_t slowest = tail;
+        while (readers != 0) {
+            uint32_t readerId = RPVC_CTZ32(readers);
+            readers &= readers - 1;
+            uint32_t cursor = RPVC_ATOMIC_LOAD(&broadcast->cursors[readerId]);
+            if (tail - cursor > tail - slowest) {
+                slowest = cursor;
+            }
+        }
+        broadcast->gate = slowest;
+        if (tail - slowest > broadcast->mask) {
+            RPVC_ATOMIC_FETCH_ADD(&entry->stats.droppedFull, 1);
+            return 0;
+        }
+    }
+
+    RPVC_SbMsgHandle_t *slot = &broadcast->ring[tail & broadcast->mask];
+    RPVC_SbMsgHandle_t previous = *slot; // every reader has moved past it
+    RPVC_ATOMIC_FETCH_ADD(&messageHandle->refCount, 1);
+    *slot = messageHandle;
+    RPVC_ATOMIC_STORE(&broadcast->tail, tail + 1U);
+    if (previous != NULL) {
+        dropReference(previous);
+    }
+    return 1;
+}
+
+// The latch keeps a reference to the newest message in place of the oldest
+// slot nobody reads. Never waits: a publisher that finds another one latching
+// leaves it the last word, as writeLatest does.
+static uint32_t latchMessage(RPVC_SbRouteEntry_t *entry, RPVC_SbMsgHandle_t messageHandle)
+{
+    if (!entry->isLatched) {
+        return 0;
+    }
+    if (!RPVC_ATOMIC_CAS(&entry->latchWriter, 0U, 1U)) {
+        return 1;
+    }
+    if (!entry->isLatched) { // disabled while this publish was on its way
+        RPVC_ATOMIC_STORE(&entry->latchWriter, 0U);
+        return 0;
+    }
+
+    // the CAS above orders the hazard load after it (see takeLatched)
+    uint32_t current = RPVC_ATOMIC_LOAD(&entry->latchCurrent);
+    uint32_t hazard = RPVC_ATOMIC_LOAD(&entry->latchHazard);
+    uint32_t slot = 0;
+    while (slot + 1U == current || slot + 1U == hazard) {
+        slot++;
+    }
+
+    RPVC_SbMsgHandle_t previous = entry->latchSlots[slot];
+    RPVC_ATOMIC_FETCH_ADD(&messageHandle->refCount, 1);
+    entry->latchSlots[slot] = messageHandle;
+    RPVC_ATOMIC_STORE(&entry->latchCurrent, slot + 1U);
+    RPVC_ATOMIC_STORE(&entry->latchWriter, 0U);
+    if (previous != NULL) {
+        dropReference(previous);
+    }
+    return 1;
+}
+
+// A reference to the latched message, or NULL. The slot is named in
+// latchHazard before it is checked to be current again, so a publisher
+// either sees the hazard and writes another slot, or has already made a
+// newer slot current and the check retries. Subscription changes are
+// serialized, so one hazard word is enough.
+static RPVC_SbMsgHandle_t takeLatched(RPVC_SbRouteEntry_t *entry)
+{
+    while (true) {
+        uint32_t current = RPVC_ATOMIC_LOAD(&entry->latchCurrent);
+        if (current == 0) {
+            return NULL;
+        }
+        RPVC_ATOMIC_STORE(&entry->latchHazard, current);
+        RPVC_ATOMIC_FENCE();
+        if (RPVC_ATOMIC_LOAD(&entry->latchCurrent) == current) {
+            RPVC_SbMsgHandle_t message = entry->latchSlots[current - 1U];
+            RPVC_ATOMIC_FETCH_ADD(&message->refCount, 1);
+            RPVC_ATOMIC_STORE(&entry->latchHazard, 0U);
+            return message;
+        }
+    }
+}
+
+// Hands a new subscriber the latched message. Runs before the route that
+// includes the pipe is committed, so a publish of the topic can only reach
+// the pipe after it; the publisher (see admitLatched) or the receiver takes
+// it from the hand-off, so the queue tails keep their single producer.
+static void handOffLatched(RPVC_SbRouteEntry_t *entry, RPVC_SbSubscriberId_t subscriberId)
+{
+    RPVC_SbMsgHandle_t message = takeLatched(entry);
+    if (message == NULL) {
+        return;
+    }
+
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    uint32_t tail = pipe->latchTail;
+    if (tail - RPVC_ATOMIC_LOAD(&pipe->latchHead) == RPVC_SB_LATCH_HANDOFF_DEPTH) {
+        RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+        RPVC_ATOMIC_FETCH_ADD(&entry->stats.droppedFull, 1);
+        dropReference(message);
+        return;
+    }
+
+    pipe->latchHandoff[tail & SB_LATCH_MASK] = message;
+    RPVC_ATOMIC_STORE(&pipe->latchTail, tail + 1U);
+    RPVC_ATOMIC_FETCH_ADD(&entry->stats.delivered, 1);
+    notifyPipe(pipe);
+}
+
+static uint8_t publishPriority(const RPVC_SbRouteEntry_t *entry, RPVC_SbMsgHandle_t messageHandle)
+{
+    return (messageHandle->flags & SB_MSG_FLAG_PRIORITY) != 0 ? messageHandle->priority : entry->priority;
+}
+
+static void stampMessage(RPVC_SbMsgHandle_t messageHandle, bool haveClock, uint32_t nowUs)
+{
+    if (RPVC_SB_ENABLE_TIMESTAMPS && haveClock) {
+        messageHandle->publishTimeUs = nowUs;
+        messageHandle->flags |= SB_MSG_FLAG_STAMPED;
+    }
+    else {
+        messageHandle->flags &= (uint8_t)~SB_MSG_FLAG_STAMPED;
+    }
+}
+
+// An explicit deadline wins; otherwise each publish starts the topic's TTL afresh
+static void applyTopicTtl(const RPVC_SbRouteEntry_t *entry, RPVC_SbMsgHandle_t messageHandle, bool haveClock, uint32_t nowUs)
+{
+    if ((messageHandle->flags & SB_MSG_FLAG_DEADLINE) != 0) {
+        return;
+    }
+    if (entry->ttlUs != 0 && haveClock) {
+        messageHandle->deadlineUs = nowUs + entry->ttlUs;
+        messageHandle->flags |= SB_MSG_FLAG_EXPIRES;
+    }
+    else {
+        messageHandle->flags &= (uint8_t)~SB_MSG_FLAG_EXPIRES;
+    }
+}
+
+// Drops the filtered pipes of the route that skip this message from pipeMask
+static uint32_t applyFilters(const RPVC_SbRoute_t *route, uint32_t pipeMask, RPVC_SbMsgHandle_t messageHandle, uint32_t nowUs)
+{
+    uint32_t pending = pipeMask & route->filteredPipes;
+    while (pending != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(pending);
+        pending &= pending - 1;
+        if (!passFilter(routeFilter(route, subscriberId), messageHandle, nowUs)) {
+            pipeMask &= ~(1U << subscriberId);
+        }
+    }
+    return pipeMask;
+}
+
+// The part of a publish that needs the read section: picks the pipes that
+// take the message and copies the handlers to call, or returns why nothing
+// may be delivered. No handler runs here (see enterRoutes).
+static RPVC_Status_t routeMessage(RPVC_SbRouteEntry_t *entry, const RPVC_SbRoute_t *route, uint32_t excludedPipes, RPVC_SbMsgHandle_t messageHandle,
+                                  uint32_t *outPipeMask, RPVC_SbCallbackEntry_t *outCallbacks, uint8_t *outCallbackCount)
+{
+    uint32_t pipeMask = route->pipes & ~excludedPipes;
+    if (pipeMask == 0 && route->callbackMask == 0 && entry->latest.capacity == 0 && !entry->isLatched &&
+        RPVC_ATOMIC_LOAD(&entry->broadcast.readers) == 0) {
+        RPVC_ATOMIC_FETCH_ADD(&entry->stats.noSubscribers, 1);
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    uint8_t priority = publishPriority(entry, messageHandle);
+    uint32_t nowUs = 0;
+    bool needClock = (pipeMask & route->rateLimitedPipes) != 0;
+    bool haveClock = (needClock || RPVC_SB_ENABLE_TIMESTAMPS || entry->ttlUs != 0) && readFilterClock(&nowUs);
+    if (needClock && !haveClock) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    // a full reject-policy pipe vetoes the publish before anything is queued
+    // (or any filter advances); receivers only ever free slots, so the answer
+    // cannot go stale
+    uint32_t pending = pipeMask;
+    while (pending != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(pending);
+        pending &= pending - 1;
+
+        RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+        if (pipe->overflowPolicy == RPVC_SB_OVERFLOW_REJECT && !isRemotePipe(pipe) && freeSlotsOf(laneQueue(pipe, priority)) == 0 &&
+            routeDemand(route, (RPVC_SbSubscriberId_t)subscriberId, 1, nowUs) > 0 &&
+            ((route->filteredPipes & (1U << subscriberId)) == 0 || matchesContent(routeFilter(route, subscriberId), messageHandle))) {
+            RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+            markStarved(pipe);
+            RPVC_ATOMIC_FETCH_ADD(&entry->stats.droppedFull, 1);
+            return RPVC_ERR_NO_RESOURCE;
+        }
+    }
+
+    *outPipeMask = applyFilters(route, pipeMask, messageHandle, nowUs);
+    *outCallbackCount = copyCallbacks(entry, route, outCallbacks);
+    messageHandle->priority = priority;
+    stampMessage(messageHandle, haveClock, nowUs);
+    applyTopicTtl(entry, messageHandle, haveClock, nowUs);
+    return RPVC_OK;
+}
+
+static RPVC_Status_t publishMessage(RPVC_SbMsgHandle_t messageHandle, uint32_t excludedPipes)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!messageHandle) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+    
+    RPVC_SbMsgId_t msgId = messageHandle->messageId;
+    if (IsValidMessageId(msgId) == false) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbRouteEntry_t *entry = &g_sbState.routes[msgId];
+    RPVC_ATOMIC_FETCH_ADD(&entry->stats.published, 1);
+    uint32_t pipeMask = 0;
+    RPVC_SbCallbackEntry_t callbacks[RPVC_SB_MAX_CALLBACKS];
+    uint8_t callbackCount = 0;
+    RPVC_SbRouteSection_t section = enterRoutes();
+    RPVC_SbRoute_t route = routeIn(section.epoch, msgId);
+    RPVC_Status_t status = routeMessage(entry, &route, excludedPipes, messageHandle, &pipeMask, callbacks, &callbackCount);
+    leaveRoutes(&section);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    uint32_t delivered = writeLatest(&entry->latest, messageHandle);
+    delivered += latchMessage(entry, messageHandle);
+    delivered += publishBroadcast(entry, messageHandle);
+    delivered += invokeCallbacks(callbacks, callbackCount, messageHandle);
+    while (pipeMask != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(pipeMask);
+        pipeMask &= pipeMask - 1;
+        delivered += deliverToPipe((RPVC_SbSubscriberId_t)subscriberId, entry, messageHandle);
+    }
+
+    if (delivered > 0) {
+        RPVC_ATOMIC_FETCH_ADD(&entry->stats.delivered, delivered);
+        return RPVC_OK;
+    }
+    else {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+}
+
+RPVC_Status_t RPVC_SB_Publish(RPVC_SbMsgHandle_t messageHandle)
+{
+    return publishMessage(messageHandle, 0);
+}
+
+RPVC_Status_t RPVC_SB_PublishExcluding(RPVC_SbMsgHandle_t messageHandle, RPVC_SbSubscriberId_t excludedSubscriberId)
+{
+    if (!IsValidSubscriber(excludedSubscriberId)) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+    return publishMessage(messageHandle, 1U << excludedSubscriberId);
+}
+
+// A commit boundary of PublishBatch on one pipe: what the batch staged goes
+// live, latched messages handed to the pipe follow, and staging restarts
+// behind them
+static void restagePipe(RPVC_SbPip_t *pipe, uint32_t *stagedTail, uint32_t *staged, uint32_t *freeSlots)
+{
+    if (*staged > 0) {
+        commitToPipe(pipe, RPVC_SB_PRIORITY_NORMAL, *stagedTail, *staged);
+        *staged = 0;
+    }
+    admitLatched(pipe);
+    *stagedTail = pipe->queue.tail;
+    *freeSlots = freeSlotsOf(&pipe->queue);
+}
+
+// Calls a batch message's handlers outside the read section and enters it
+// again. If a subscription change committed meanwhile, the routes of the
+// batch are copied again: the filter slots the old ones name may be
+// refilled by the next change.
+static uint32_t invokeBatchCallbacks(RPVC_SbRouteSection_t *section, RPVC_SbRoute_t *routes, const uint32_t *occurrences, RPVC_SbMsgHandle_t messageHandle)
+{
+    RPVC_SbMsgId_t msgId = messageHandle->messageId;
+    RPVC_SbCallbackEntry_t callbacks[RPVC_SB_MAX_CALLBACKS];
+    uint8_t callbackCount = copyCallbacks(&g_sbState.routes[msgId], &routes[msgId], callbacks);
+    leaveRoutes(section);
+    uint32_t called = invokeCallbacks(callbacks, callbackCount, messageHandle);
+
+    uint32_t seen = section->epoch;
+    *section = enterRoutes();
+    if (section->epoch != seen) {
+        for (size_t id = 0; id < RPVC_SB_MAX_MESSAGE_ID; id++) {
+            if (occurrences[id] != 0) {
+                routes[id] = routeIn(section->epoch, (RPVC_SbMsgId_t)id);
+            }
+        }
+    }
+    return called;
+}
+
+RPVC_Status_t RPVC_SB_PublishBatch(const RPVC_SbMsgHandle_t *messageHandles, size_t count)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (messageHandles == NULL || count == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (messageHandles[i] == NULL || !IsValidMessageId(messageHandles[i]->messageId)) {
+            return RPVC_ERR_INVALID_ARG;
+        }
+    }
+
+    RPVC_SbRoute_t routes[RPVC_SB_MAX_MESSAGE_ID];
+    uint32_t occurrences[RPVC_SB_MAX_MESSAGE_ID] = {0};
+    uint32_t normalOccurrences[RPVC_SB_MAX_MESSAGE_ID] = {0}; // the ones staged in priority-0 queues
+    bool needClock = false;
+    bool wantClock = RPVC_SB_ENABLE_TIMESTAMPS;
+
+    RPVC_SbRouteSection_t section = enterRoutes();
+    for (size_t i = 0; i < count; i++) {
+        RPVC_SbMsgId_t msgId = messageHandles[i]->messageId;
+        if (occurrences[msgId]++ == 0) {
+            routes[msgId] = routeIn(section.epoch, msgId);
+            needClock |= (routes[msgId].pipes & routes[msgId].rateLimitedPipes) != 0;
+            wantClock |= g_sbState.routes[msgId].ttlUs != 0;
+        }
+        if (publishPriority(&g_sbState.routes[msgId], messageHandles[i]) == RPVC_SB_PRIORITY_NORMAL) {
+            normalOccurrences[msgId]++;
+        }
+    }
+
+    for (size_t msgId = 0; msgId < RPVC_SB_MAX_MESSAGE_ID; msgId++) {
+        if (occurrences[msgId] != 0) {
+            RPVC_ATOMIC_FETCH_ADD(&g_sbState.routes[msgId].stats.published, occurrences[msgId]);
+        }
+    }
+
+    // one timestamp for the whole batch
+    uint32_t nowUs = 0;
+    bool haveClock = (needClock || wantClock) && readFilterClock(&nowUs);
+    if (needClock && !haveClock) {
+        leaveRoutes(&section);
+        return RPVC_ERR_NOT_READY;
+    }
+
+    uint32_t rejectDemand[RPVC_SB_MAX_PIPES] = {0};
+    uint32_t rejectPipes = 0;
+    for (size_t msgId = 0; msgId < RPVC_SB_MAX_MESSAGE_ID; msgId++) {
+        if (occurrences[msgId] == 0) {
+            continue;
+        }
+        uint32_t pending = routes[msgId].pipes;
+        while (pending != 0) {
+            uint32_t subscriberId = RPVC_CTZ32(pending);
+            pending &= pending - 1;
+            RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+            if (pipe->overflowPolicy == RPVC_SB_OVERFLOW_REJECT && !isRemotePipe(pipe)) {
+                rejectDemand[subscriberId] += routeDemand(&routes[msgId], (RPVC_SbSubscriberId_t)subscriberId, normalOccurrences[msgId], nowUs);
+                rejectPipes |= 1U << subscriberId;
+            }
+        }
+    }
+
+    // reject-policy pipes veto the whole batch before anything is queued
+    while (rejectPipes != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(rejectPipes);
+        rejectPipes &= rejectPipes - 1;
+
+        RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+        if (rejectDemand[subscriberId] > freeSlotsOf(&pipe->queue)) {
+            RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, rejectDemand[subscriberId]);
+            markStarved(pipe);
+            // a vetoed batch loses every message the pipe would have taken
+            for (size_t msgId = 0; msgId < RPVC_SB_MAX_MESSAGE_ID; msgId++) {
+                if (occurrences[msgId] != 0 && (routes[msgId].pipes & (1U << subscriberId)) != 0) {
+                    uint32_t lost = routeDemand(&routes[msgId], (RPVC_SbSubscriberId_t)subscriberId, normalOccurrences[msgId], nowUs);
+                    RPVC_ATOMIC_FETCH_ADD(&g_sbState.routes[msgId].stats.droppedFull, lost);
+                }
+            }
+            leaveRoutes(&section);
+            return RPVC_ERR_NO_RESOURCE;
+        }
+    }
+
+    uint32_t freeSlots[RPVC_SB_MAX_PIPES];
+    uint32_t stagedTail[RPVC_SB_MAX_PIPES];
+    uint32_t staged[RPVC_SB_MAX_PIPES] = {0};
+    uint32_t touchedPipes = 0;
+    bool allDelivered = true;
+
+    for (size_t i = 0; i < count; i++) {
+        RPVC_SbMsgHandle_t messageHandle = messageHandles[i];
+        uint32_t delivered = 0;
+        RPVC_SbMsgId_t msgId = messageHandle->messageId;
+        RPVC_SbRouteEntry_t *entry = &g_sbState.routes[msgId];
+        if (routes[msgId].pipes == 0 && routes[msgId].callbackMask == 0 && entry->latest.capacity == 0 && !entry->isLatched &&
+            RPVC_ATOMIC_LOAD(&entry->broadcast.readers) == 0) {
+            RPVC_ATOMIC_FETCH_ADD(&entry->stats.noSubscribers, 1);
+            allDelivered = false;
+            continue;
+        }
+
+        uint32_t pending = applyFilters(&routes[msgId], routes[msgId].pipes, messageHandle, nowUs);
+        messageHandle->priority = publishPriority(entry, messageHandle);
+        stampMessage(messageHandle, haveClock, nowUs);
+        applyTopicTtl(entry, messageHandle, haveClock, nowUs);
+        uint32_t handled = writeLatest(&entry->latest, messageHandle);
+        handled += latchMessage(entry, messageHandle);
+        handled += publishBroadcast(entry, messageHandle);
+        if (routes[msgId].callbackMask != 0) {
+            uint32_t seen = section.epoch;
+            handled += invokeBatchCallbacks(&section, routes, occurrences, messageHandle);
+            // a handler's subscription may have handed a latched message to a
+            // pipe the batch is filling; it goes in ahead of the rest
+            uint32_t restage = section.epoch != seen ? touchedPipes : 0U;
+            while (restage != 0) {
+                uint32_t subscriberId = RPVC_CTZ32(restage);
+                restage &= restage - 1;
+                restagePipe(&g_sbState.pipes[subscriberId], &stagedTail[subscriberId], &staged[subscriberId], &freeSlots[subscriberId]);
+            }
+        }
+        while (pending != 0) {
+            uint32_t subscriberId = RPVC_CTZ32(pending);
+            pending &= pending - 1;
+
+            RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+            if (isRemotePipe(pipe)) {
+                handled += postToOwner((RPVC_SbSubscriberId_t)subscriberId, entry, messageHandle);
+                continue;
+            }
+            uint32_t pipeBit = 1U << subscriberId;
+            if ((touchedPipes & pipeBit) == 0) {
+                restagePipe(pipe, &stagedTail[subscriberId], &staged[subscriberId], &freeSlots[subscriberId]);
+                touchedPipes |= pipeBit;
+            }
+            if (messageHandle->priority != RPVC_SB_PRIORITY_NORMAL) {
+                // urgent lanes are not staged; their overflow is handled per message
+                handled += queueToPipe(pipe, entry, messageHandle);
+                continue;
+            }
+
+            if (freeSlots[subscriberId] == 0) {
+                if (pipe->overflowPolicy != RPVC_SB_OVERFLOW_DROP_OLDEST) {
+                    RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+                    markStarved(pipe);
+                    RPVC_ATOMIC_FETCH_ADD(&entry->stats.droppedFull, 1);
+                    continue;
+                }
+                // staged slots are not claimable yet, so publish them before evicting
+                if (staged[subscriberId] > 0) {
+                    commitToPipe(pipe, RPVC_SB_PRIORITY_NORMAL, stagedTail[subscriberId], staged[subscriberId]);
+                    staged[subscriberId] = 0;
+                }
+                evictOldest(pipe, &pipe->queue);
+                freeSlots[subscriberId] = freeSlotsOf(&pipe->queue);
+            }
+
+            // stage behind the shared tail; the receiver cannot see it yet
+            uint32_t tail = stagedTail[subscriberId];
+            pipe->queue.buffer[tail % pipe->queue.depth] = messageHandle;
+            stagedTail[subscriberId] = advanceIndex(&pipe->queue, tail, 1);
+            freeSlots[subscriberId]--;
+            staged[subscriberId]++;
+            delivered++;
+        }
+
+        if (delivered > 0) {
+            RPVC_ATOMIC_FETCH_ADD(&messageHandle->refCount, delivered);
+        }
+        else if (handled == 0) {
+            allDelivered = false;
+        }
+        if (delivered + handled > 0) {
+            RPVC_ATOMIC_FETCH_ADD(&entry->stats.delivered, delivered + handled);
+        }
+    }
+    leaveRoutes(&section);
+
+    while (touchedPipes != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(touchedPipes);
+        touchedPipes &= touchedPipes - 1;
+
+        if (staged[subscriberId] > 0) {
+            commitToPipe(&g_sbState.pipes[subscriberId], RPVC_SB_PRIORITY_NORMAL, stagedTail[subscriberId], staged[subscriberId]);
+        }
+    }
+
+    return allDelivered ? RPVC_OK : RPVC_ERR_OUT_OF_RANGE;
+}
+
+static uint32_t latencyBucket(uint32_t latencyUs)
+{
+    uint32_t bucket = 0;
+    while (latencyUs != 0 && bucket < RPVC_SB_LATENCY_BUCKETS - 1) {
+        latencyUs >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Counts messages a receiver took and, when they carry a publish time, how long they waited
+static void recordReceived(RPVC_SbPip_t *pipe, const RPVC_SbMsgHandle_t *messageHandles, uint32_t count)
+{
+    RPVC_ATOMIC_FETCH_ADD(&pipe->receivedCount, count);
+
+    uint32_t nowUs = 0;
+    if (!RPVC_SB_ENABLE_TIMESTAMPS || !readFilterClock(&nowUs)) {
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if ((messageHandles[i]->flags & SB_MSG_FLAG_STAMPED) != 0) {
+            uint32_t latencyUs = nowUs - messageHandles[i]->publishTimeUs;
+            RPVC_ATOMIC_FETCH_ADD(&g_sbState.latencyUs[latencyBucket(latencyUs)], 1);
+        }
+    }
+}
+
+// The clock is read at most once per receive call, and only for a message with a deadline
+static bool isExpired(RPVC_SbMsgHandle_t messageHandle, bool *clockRead, uint32_t *nowUs)
+{
+    if ((messageHandle->flags & SB_MSG_FLAG_EXPIRES) == 0) {
+        return false;
+    }
+    if (!*clockRead) {
+        if (!readFilterClock(nowUs)) {
+            return false;
+        }
+        *clockRead = true;
+    }
+    return (int32_t)(*nowUs - messageHandle->deadlineUs) >= 0;
+}
+
+// The credit callback and context as last set, never one of each. Retries
+// only if they are set twice while being copied.
+static RPVC_SbCreditHandler_t readCreditHandler(RPVC_SbRouteEntry_t *entry)
+{
+    while (true) {
+        uint32_t completed = RPVC_ATOMIC_LOAD(&entry->creditSequence) / 2U;
+        RPVC_SbCreditHandler_t handler = entry->creditHandlers[completed & 1U];
+
+        // the copy is good unless a setter has since started on the same slot
+        RPVC_ATOMIC_FENCE();
+        if ((uint32_t)(RPVC_ATOMIC_LOAD(&entry->creditSequence) - completed * 2U) <= 2U) {
+            return handler;
+        }
+    }
+}
+
+// Receiver side, after taking messages. Only a pipe marked starved (a publish
+// found it full, or a RPVC_SB_WaitCredit caller is short of room on it) wakes
+// the credit waiters and runs the credit callbacks of its topics; the flag is
+// cleared here, so one token per waiter goes out per marking.
+static void returnCredit(RPVC_SbPip_t *pipe)
+{
+    if (RPVC_ATOMIC_LOAD(&pipe->starved) == 0 || !RPVC_ATOMIC_CAS(&pipe->starved, 1U, 0U)) {
+        return;
+    }
+
+    uint32_t waiters = RPVC_ATOMIC_LOAD(&g_sbState.creditWaiters);
+    RPVC_OS_Sem *sem = g_sbState.creditSem;
+    for (uint32_t i = 0; i < waiters && sem != NULL; i++) {
+        (void)RPVC_OS_SemSignal(sem);
+    }
+
+    uint32_t pipeBit = 1U << (pipe - g_sbState.pipes);
+    for (size_t msgId = 0; msgId < RPVC_SB_MAX_MESSAGE_ID; msgId++) {
+        RPVC_SbCreditHandler_t handler = readCreditHandler(&g_sbState.routes[msgId]);
+        if (handler.callback != NULL && (resolveRoute((RPVC_SbMsgId_t)msgId).pipes & pipeBit) != 0) {
+            handler.callback((RPVC_SbMsgId_t)msgId, handler.context);
+        }
+    }
+}
+
+// claimByPriority for the receive calls: expired messages are released on the
+// spot, so a consumer that fell behind goes straight to current data
+static uint32_t claimFresh(RPVC_SbPip_t *pipe, RPVC_SbMsgHandle_t *outHandles, uint32_t maxCount)
+{
+    bool clockRead = false;
+    uint32_t nowUs = 0;
+    while (true) {
+        // hand-offs predate anything queued for their topics
+        uint32_t claimed = claimLatched(pipe, outHandles, maxCount);
+#if RPVC_SB_MAX_SHARDS > 1
+        drainMailboxes((RPVC_SbSubscriberId_t)(pipe - g_sbState.pipes), false);
+#endif
+        claimed += claimByPriority(pipe, outHandles + claimed, maxCount - claimed);
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < claimed; i++) {
+            RPVC_SbMsgHandle_t message = outHandles[i];
+            if (isExpired(message, &clockRead, &nowUs)) {
+                RPVC_ATOMIC_FETCH_ADD(&g_sbState.routes[message->messageId].stats.expired, 1);
+                dropReference(message);
+            }
+            else {
+                outHandles[kept++] = message;
+            }
+        }
+
+        if (kept < claimed) {
+            RPVC_ATOMIC_FETCH_ADD(&pipe->expiredCount, claimed - kept);
+        }
+        if (claimed > 0) {
+            returnCredit(pipe);
+        }
+        if (kept > 0 || claimed == 0) {
+            recordReceived(pipe, outHandles, kept);
+            return kept;
+        }
+    }
+}
+
+// Claims the oldest message, copies it out and only then drops the pipe's
+// reference, so the publisher cannot release the block while it is being read.
+static bool copyAndPopMessageFromPipe(RPVC_SbPip_t *pipe, uint8_t *outBuffer, size_t bufferSize) 
+{
+    RPVC_SbMsgHandle_t message;
+    if (claimFresh(pipe, &message, 1) == 0) {
+        return false;
+    }
+
+    size_t copySize = message->len < bufferSize ? message->len : bufferSize;
+    memcpy(outBuffer, message->payload, copySize);
+    dropReference(message);
+    return true;
+}
+
+RPVC_Status_t RPVC_SB_Receive(RPVC_SbSubscriberId_t subscriberId, uint8_t *outBuffer, size_t bufferSize)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidSubscriber(subscriberId) || outBuffer == NULL || bufferSize == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    if (!pipe->isInitialized || !copyAndPopMessageFromPipe(pipe, outBuffer, bufferSize)) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+    return RPVC_OK;
+}
+
+// Start of a finite, non-zero wait; timeouts are counted from here
+static RPVC_Status_t readWaitStart(uint32_t timeoutMs, uint64_t *outStartUs)
+{
+    *outStartUs = 0;
+    if (timeoutMs != RPVC_SB_WAIT_FOREVER && timeoutMs != 0 && RPVC_OS_GetTimeMicroseconds(outStartUs) != RPVC_OK) {
+        return RPVC_ERR_NOT_READY;
+    }
+    return RPVC_OK;
+}
+
+// Claims the oldest message of a pipe, sleeping until one arrives or
+// timeoutMs after startUs; the caller then owns the pipe's reference.
+static RPVC_Status_t waitForMessage(RPVC_SbPip_t *pipe, uint32_t timeoutMs, uint64_t startUs, RPVC_SbMsgHandle_t *outMessage)
+{
+    while (true) {
+        if (claimFresh(pipe, outMessage, 1) == 1) {
+            return RPVC_OK;
+        }
+
+        if (timeoutMs == 0) {
+            return RPVC_ERR_TIMEOUT;
+        }
+
+        if (pipe->dataSem == NULL) {
+            RPVC_OS_Sem *sem = NULL;
+            if (RPVC_OS_SemAlloc(&sem, 0) != 0) {
+                return RPVC_ERR_NO_RESOURCE;
+            }
+            pipe->dataSem = sem;
+            // a publish that raced the install is caught by the re-check below
+            RPVC_ATOMIC_FENCE();
+            continue;
+        }
+
+        uint32_t waitMs = RPVC_SB_WAIT_FOREVER;
+        if (timeoutMs != RPVC_SB_WAIT_FOREVER) {
+            uint64_t nowUs = 0;
+            if (RPVC_OS_GetTimeMicroseconds(&nowUs) != RPVC_OK) {
+                return RPVC_ERR_NOT_READY;
+            }
+            uint64_t elapsedMs = (nowUs - startUs) / 1000U;
+            if (elapsedMs >= timeoutMs) {
+                return RPVC_ERR_TIMEOUT;
+            }
+            waitMs = timeoutMs - (uint32_t)elapsedMs;
+        }
+
+        // stale signals (from messages taken by RPVC_SB_Receive) only cause a re-check
+        (void)RPVC_OS_SemWait(pipe->dataSem, waitMs);
+    }
+}
+
+RPVC_Status_t RPVC_SB_ReceiveTimeout(RPVC_SbSubscriberId_t subscriberId, uint8_t *outBuffer, size_t bufferSize, uint32_t timeoutMs)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidSubscriber(subscriberId) || outBuffer == NULL || bufferSize == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    if (!pipe->isInitialized) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    uint64_t startUs = 0;
+    RPVC_Status_t status = readWaitStart(timeoutMs, &startUs);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    RPVC_SbMsgHandle_t message = NULL;
+    status = waitForMessage(pipe, timeoutMs, startUs, &message);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    size_t copySize = message->len < bufferSize ? message->len : bufferSize;
+    memcpy(outBuffer, message->payload, copySize);
+    dropReference(message);
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_ReceiveBatch(RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgHandle_t *outHandles, size_t maxHandles, size_t *outCount)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidSubscriber(subscriberId) || outHandles == NULL || maxHandles == 0 || outCount == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outCount = 0;
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+    if (!pipe->isInitialized) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    // the pipe's references move to the caller
+    uint32_t maxCount = maxHandles < UINT32_MAX ? (uint32_t)maxHandles : UINT32_MAX;
+    uint32_t taken = claimFresh(pipe, outHandles, maxCount);
+    if (taken == 0) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    *outCount = taken;
+    return RPVC_OK;
+}
+
+// Drops the reference of every message queued in the pipe's lanes and empties them
+static void releaseQueued(RPVC_SbPip_t *pipe)
+{
+    for (uint32_t priority = 0; priority < RPVC_SB_PRIORITY_LANES; priority++) {
+        RPVC_SbQueue_t *queue = laneQueue(pipe, (uint8_t)priority);
+        for (uint32_t index = queue->head; index != queue->tail; index = advanceIndex(queue, index, 1)) {
+            dropReference(queue->buffer[index % queue->depth]);
+        }
+        queue->head = 0;
+        queue->tail = 0;
+        RPVC_ATOMIC_STORE(&queue->count, 0U);
+    }
+#if RPVC_SB_PRIORITY_LANES > 1
+    RPVC_ATOMIC_STORE(&pipe->pendingLanes, 0U);
+#endif
+}
+
+RPVC_Status_t RPVC_SB_Flush(RPVC_SbSubscriberId_t subscriberId)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidSubscriber(subscriberId)) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+#if RPVC_SB_MAX_SHARDS > 1
+    drainMailboxes(subscriberId, true);
+#endif
+    releaseQueued(pipe);
+    RPVC_SbMsgHandle_t latched;
+    while (claimLatched(pipe, &latched, 1) == 1) {
+        dropReference(latched);
+    }
+    pipe->isInitialized = false;
+    
+    return RPVC_OK;
+}
+
+// Room a publish of messageId has left in one pipe: the lane it lands in, or
+// for a pipe of another shard the caller's mailbox to it
+static uint32_t pipeCredit(RPVC_SbMsgId_t messageId, RPVC_SbSubscriberId_t subscriberId)
+{
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[subscriberId];
+#if RPVC_SB_MAX_SHARDS > 1
+    if (isRemotePipe(pipe)) {
+        RPVC_SbMailbox_t *mailbox = &g_sbState.mailboxes[t_shard][subscriberId];
+        return RPVC_SB_SHARD_MAILBOX_DEPTH - (RPVC_ATOMIC_LOAD(&mailbox->tail) - RPVC_ATOMIC_LOAD(&mailbox->head));
+    }
+#endif
+    return freeSlotsOf(laneQueue(pipe, g_sbState.routes[messageId].priority));
+}
+
+// Smallest room left across the pipes a publish of messageId would reach.
+// With markShort, a pipe with less than minCredit room is marked starved and
+// then read again, so a receive that frees room either shows up in the second
+// read or finds the mark and wakes the credit waiters.
+static uint32_t topicCredit(RPVC_SbMsgId_t messageId, uint32_t minCredit, bool markShort)
+{
+    uint32_t credit = UINT32_MAX;
+    uint32_t pipeMask = resolveRoute(messageId).pipes;
+    while (pipeMask != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(pipeMask);
+        pipeMask &= pipeMask - 1;
+
+        uint32_t room = pipeCredit(messageId, (RPVC_SbSubscriberId_t)subscriberId);
+        if (markShort && room < minCredit) {
+            markStarved(&g_sbState.pipes[subscriberId]);
+            RPVC_ATOMIC_FENCE();
+            room = pipeCredit(messageId, (RPVC_SbSubscriberId_t)subscriberId);
+        }
+        if (room < credit) {
+            credit = room;
+        }
+    }
+    return credit;
+}
+
+RPVC_Status_t RPVC_SB_GetCredit(RPVC_SbMsgId_t messageId, uint32_t *outCredit)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || outCredit == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outCredit = topicCredit(messageId, 0, false);
+    return RPVC_OK;
+}
+
+// The semaphore is shared, so only the caller that claims it allocates it;
+// the others sleep briefly until it is installed
+static RPVC_Status_t installCreditSem(void)
+{
+    if (!RPVC_ATOMIC_CAS(&g_sbState.creditSemClaimed, 0U, 1U)) {
+        return RPVC_OS_TaskSleep(1) == RPVC_OK ? RPVC_OK : RPVC_ERR_NO_RESOURCE;
+    }
+
+    RPVC_OS_Sem *sem = NULL;
+    if (RPVC_OS_SemAlloc(&sem, 0) != 0) {
+        RPVC_ATOMIC_STORE(&g_sbState.creditSemClaimed, 0U);
+        return RPVC_ERR_NO_RESOURCE;
+    }
+    g_sbState.creditSem = sem;
+    RPVC_ATOMIC_FENCE();
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_WaitCredit(RPVC_SbMsgId_t messageId, uint32_t minCredit, uint32_t timeoutMs)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || minCredit == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    uint64_t startUs = 0;
+    RPVC_Status_t status = readWaitStart(timeoutMs, &startUs);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    while (topicCredit(messageId, minCredit, false) < minCredit) {
+        if (timeoutMs == 0) {
+            return RPVC_ERR_TIMEOUT;
+        }
+
+        uint32_t waitMs = RPVC_SB_WAIT_FOREVER;
+        if (timeoutMs != RPVC_SB_WAIT_FOREVER) {
+            uint64_t nowUs = 0;
+            if (RPVC_OS_GetTimeMicroseconds(&nowUs) != RPVC_OK) {
+                return RPVC_ERR_NOT_READY;
+            }
+            uint64_t elapsedMs = (nowUs - startUs) / 1000U;
+            if (elapsedMs >= timeoutMs) {
+                return RPVC_ERR_TIMEOUT;
+            }
+            waitMs = timeoutMs - (uint32_t)elapsedMs;
+        }
+
+        RPVC_OS_Sem *sem = g_sbState.creditSem;
+        if (sem == NULL) {
+            status = installCreditSem();
+            if (status != RPVC_OK) {
+                return status;
+            }
+            continue;
+        }
+
+        // register and mark the short pipes before the re-check, so a
+        // receiver that frees room from now on finds the mark and signals us
+        RPVC_ATOMIC_FETCH_ADD(&g_sbState.creditWaiters, 1);
+        RPVC_ATOMIC_FENCE();
+        if (topicCredit(messageId, minCredit, true) < minCredit) {
+            (void)RPVC_OS_SemWait(sem, waitMs);
+        }
+        RPVC_ATOMIC_FETCH_SUB(&g_sbState.creditWaiters, 1);
+    }
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_SetCreditCallback(RPVC_SbMsgId_t messageId, RPVC_SbCreditCallback_t callback, void *context)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId)) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    // setters take turns, so only receivers can overlap a set
+    RPVC_SbRouteEntry_t *entry = &g_sbState.routes[messageId];
+    lockRouteWriter();
+    uint32_t sequence = entry->creditSequence;
+    RPVC_ATOMIC_STORE(&entry->creditSequence, sequence + 1U);
+    RPVC_ATOMIC_FENCE();
+    RPVC_SbCreditHandler_t *slot = &entry->creditHandlers[(sequence / 2U + 1U) & 1U];
+    slot->callback = callback;
+    slot->context = context;
+    RPVC_ATOMIC_STORE(&entry->creditSequence, sequence + 2U);
+    unlockRouteWriter();
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_GetStats(RPVC_SbStats_t *outStats)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (outStats == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < RPVC_SB_MAX_MESSAGE_ID; i++) {
+        RPVC_SbTopicStats_t *stats = &g_sbState.routes[i].stats;
+        outStats->topics[i].published = RPVC_ATOMIC_LOAD(&stats->published);
+        outStats->topics[i].delivered = RPVC_ATOMIC_LOAD(&stats->delivered);
+        outStats->topics[i].droppedFull = RPVC_ATOMIC_LOAD(&stats->droppedFull);
+        outStats->topics[i].noSubscribers = RPVC_ATOMIC_LOAD(&stats->noSubscribers);
+        outStats->topics[i].expired = RPVC_ATOMIC_LOAD(&stats->expired);
+    }
+
+    for (size_t i = 0; i < RPVC_SB_MAX_PIPES; i++) {
+        RPVC_SbPip_t *pipe = &g_sbState.pipes[i];
+        outStats->pipes[i].depth = queuedInPipe(pipe);
+        outStats->pipes[i].peakDepth = RPVC_ATOMIC_LOAD(&pipe->peakDepth);
+        outStats->pipes[i].received = RPVC_ATOMIC_LOAD(&pipe->receivedCount);
+        outStats->pipes[i].dropped = RPVC_ATOMIC_LOAD(&pipe->dropCount);
+        outStats->pipes[i].expired = RPVC_ATOMIC_LOAD(&pipe->expiredCount);
+    }
+
+    for (size_t i = 0; i < RPVC_SB_LATENCY_BUCKETS; i++) {
+        outStats->latencyUs[i] = RPVC_ATOMIC_LOAD(&g_sbState.latencyUs[i]);
+    }
+    return RPVC_OK;
+}
+
+static RPVC_Status_t allocateMessage(RPVC_SbMsgId_t messageId, size_t payloadSize, uint8_t flags, RPVC_SbMsgHandle_t *outMessageHandle)
+{
+    RPVC_SbMsgHandle_t newmessage = NULL;
+    RPVC_Status_t status = allocateMessageBlock(sizeof(RPVC_SbMsg_t) + payloadSize, (void**)&newmessage);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    newmessage->messageId = messageId;
+    newmessage->len = (uint16_t)payloadSize;
+    newmessage->flags = flags;
+    newmessage->rpcParam = 0;
+    newmessage->correlationId = 0;
+    newmessage->publishTimeUs = 0;
+    newmessage->deadlineUs = 0;
+    newmessage->priority = RPVC_SB_PRIORITY_NORMAL;
+    memset(newmessage->reserved, 0, sizeof(newmessage->reserved));
+    newmessage->refCount = 1; // creator's (or loan holder's) reference
+    *outMessageHandle = newmessage;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_CreateMessage(RPVC_SbMsgId_t messageId, const uint8_t *messageData, size_t messageSize, RPVC_SbMsgHandle_t *outMessageHandle)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || !outMessageHandle || !messageData) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    size_t trueSize = messageSize > RPVC_SB_MAX_PAYLOAD_SIZE ? RPVC_SB_MAX_PAYLOAD_SIZE : messageSize;
+    RPVC_SbMsgHandle_t newmessage = NULL;
+    RPVC_Status_t status = allocateMessage(messageId, trueSize, 0, &newmessage);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    memcpy(newmessage->payload, messageData, trueSize);
+    *outMessageHandle = newmessage;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_LoanMessage(RPVC_SbMsgId_t messageId, size_t messageSize, RPVC_SbMsgHandle_t *outMessageHandle, uint8_t **outWritePtr)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(messageId) || !outMessageHandle || !outWritePtr || messageSize > RPVC_SB_MAX_PAYLOAD_SIZE) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbMsgHandle_t newmessage = NULL;
+    RPVC_Status_t status = allocateMessage(messageId, messageSize, SB_MSG_FLAG_LOANED, &newmessage);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    *outMessageHandle = newmessage;
+    *outWritePtr = newmessage->payload;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_PublishLoaned(RPVC_SbMsgHandle_t messageHandle)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!messageHandle) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    if ((messageHandle->flags & SB_MSG_FLAG_LOANED) == 0) {
+        return RPVC_ERR_STATE;
+    }
+
+    messageHandle->flags &= (uint8_t)~SB_MSG_FLAG_LOANED;
+    RPVC_Status_t status = RPVC_SB_Publish(messageHandle);
+    dropReference(messageHandle); // the loan ends here; pipes keep their own references
+    return status;
+}
+
+RPVC_Status_t RPVC_SB_ReleaseMessage(RPVC_SbMsgHandle_t messageHandle)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!messageHandle) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    if (RPVC_ATOMIC_LOAD(&messageHandle->refCount) == 0) { // already returned to the pool
+        return RPVC_ERR_STATE;
+    }
+
+    dropReference(messageHandle);
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_GetMessagePayload(RPVC_SbMsgHandle_t messageHandle, const uint8_t **outData, size_t *outSize)
+{
+    if (!messageHandle || !outData || !outSize) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outData = messageHandle->payload;
+    *outSize = messageHandle->len;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_GetMessageId(RPVC_SbMsgHandle_t messageHandle, RPVC_SbMsgId_t *outMessageId)
+{
+    if (!messageHandle || !outMessageId) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outMessageId = messageHandle->messageId;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_SetMessageDeadline(RPVC_SbMsgHandle_t messageHandle, uint32_t ttlUs)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!messageHandle || ttlUs > RPVC_SB_MAX_TTL_US) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    // queued copies share the header, so it only changes while nothing else holds it
+    if (RPVC_ATOMIC_LOAD(&messageHandle->refCount) != 1) {
+        return RPVC_ERR_STATE;
+    }
+
+    if (ttlUs == 0) {
+        messageHandle->flags &= (uint8_t)~(SB_MSG_FLAG_DEADLINE | SB_MSG_FLAG_EXPIRES);
+        return RPVC_OK;
+    }
+
+    uint32_t nowUs = 0;
+    if (!readFilterClock(&nowUs)) {
+        return RPVC_ERR_NOT_READY;
+    }
+    messageHandle->deadlineUs = nowUs + ttlUs;
+    messageHandle->flags |= SB_MSG_FLAG_DEADLINE | SB_MSG_FLAG_EXPIRES;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_SetMessagePriority(RPVC_SbMsgHandle_t messageHandle, uint8_t priority)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!messageHandle || priority >= RPVC_SB_PRIORITY_LANES) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    // queued copies share the header, so it only changes while nothing else holds it
+    if (RPVC_ATOMIC_LOAD(&messageHandle->refCount) != 1) {
+        return RPVC_ERR_STATE;
+    }
+
+    messageHandle->priority = priority;
+    messageHandle->flags |= SB_MSG_FLAG_PRIORITY;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_Request(RPVC_SbMsgId_t serviceId, RPVC_SbSubscriberId_t replyPipeId, const uint8_t *request, size_t requestSize,
+                              uint8_t *outReply, size_t replyBufferSize, size_t *outReplySize, uint32_t timeoutMs)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidMessageId(serviceId) || !IsValidSubscriber(replyPipeId) || (request == NULL && requestSize > 0) ||
+        requestSize > RPVC_SB_MAX_PAYLOAD_SIZE || (outReply == NULL && replyBufferSize > 0)) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    // like a subscription, a request activates the pipe it listens on, but
+    // only one the caller has set up
+    RPVC_SbPip_t *replyPipe = &g_sbState.pipes[replyPipeId];
+    if (!replyPipe->isCreated && !replyPipe->isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+    replyPipe->isInitialized = true;
+
+    uint64_t startUs = 0;
+    RPVC_Status_t status = readWaitStart(timeoutMs, &startUs);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    RPVC_SbMsgHandle_t message = NULL;
+    status = allocateMessage(serviceId, requestSize, SB_MSG_FLAG_REQUEST, &message);
+    if (status != RPVC_OK) {
+        return status;
+    }
+    if (requestSize > 0) {
+        memcpy(message->payload, request, requestSize);
+    }
+    uint16_t correlationId = (uint16_t)RPVC_ATOMIC_FETCH_ADD(&g_sbState.nextCorrelationId, 1);
+    message->rpcParam = (uint8_t)replyPipeId;
+    message->correlationId = correlationId;
+
+    status = RPVC_SB_Publish(message);
+    dropReference(message);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    while (true) {
+        RPVC_SbMsgHandle_t reply = NULL;
+        status = waitForMessage(replyPipe, timeoutMs, startUs, &reply);
+        if (status != RPVC_OK) {
+            return status;
+        }
+
+        // replies to earlier requests that timed out are discarded
+        if ((reply->flags & SB_MSG_FLAG_REPLY) != 0 && reply->correlationId == correlationId) {
+            size_t copySize = reply->len < replyBufferSize ? reply->len : replyBufferSize;
+            if (copySize > 0) {
+                memcpy(outReply, reply->payload, copySize);
+            }
+            if (outReplySize != NULL) {
+                *outReplySize = reply->len;
+            }
+            status = (RPVC_Status_t)(int8_t)reply->rpcParam;
+            dropReference(reply);
+            return status;
+        }
+        dropReference(reply);
+    }
+}
+
+// Replies skip the route table: they go straight to the requester's pipe,
+// in the request's lane and under that pipe's overflow policy
+static void serveRequest(RPVC_SbMsgHandle_t request, RPVC_SbServiceHandler_t handler, void *context)
+{
+    uint8_t replyBuffer[RPVC_SB_MAX_PAYLOAD_SIZE];
+    size_t replySize = 0;
+    RPVC_Status_t result = handler(request->messageId, request->payload, request->len,
+                                   replyBuffer, sizeof(replyBuffer), &replySize, context);
+    if (replySize > sizeof(replyBuffer) || result != RPVC_OK) {
+        replySize = 0;
+    }
+
+    RPVC_SbMsgHandle_t reply = NULL;
+    if (allocateMessage(request->messageId, replySize, SB_MSG_FLAG_REPLY, &reply) != RPVC_OK) {
+        return; // the requester times out
+    }
+    memcpy(reply->payload, replyBuffer, replySize);
+    reply->rpcParam = (uint8_t)(int8_t)result;
+    reply->correlationId = request->correlationId;
+    reply->priority = request->priority;
+
+    RPVC_SbPip_t *replyPipe = &g_sbState.pipes[request->rpcParam];
+    if (replyPipe->isInitialized) {
+        (void)deliverToPipe(request->rpcParam, &g_sbState.routes[reply->messageId], reply);
+    }
+    else {
+        RPVC_ATOMIC_FETCH_ADD(&replyPipe->dropCount, 1);
+    }
+    dropReference(reply);
+}
+
+RPVC_Status_t RPVC_SB_Serve(RPVC_SbSubscriberId_t requestPipeId, RPVC_SbServiceHandler_t handler, void *context, uint32_t timeoutMs)
+{
+    if (!g_sbState.isInitialized) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (!IsValidSubscriber(requestPipeId) || handler == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    RPVC_SbPip_t *pipe = &g_sbState.pipes[requestPipeId];
+    if (!pipe->isInitialized) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    uint64_t startUs = 0;
+    RPVC_Status_t status = readWaitStart(timeoutMs, &startUs);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    // wait for the first request only, then answer whatever else is queued
+    RPVC_SbMsgHandle_t request = NULL;
+    status = waitForMessage(pipe, timeoutMs, startUs, &request);
+    if (status != RPVC_OK) {
+        return status;
+    }
+    do {
+        if ((request->flags & SB_MSG_FLAG_REQUEST) != 0 && IsValidSubscriber(request->rpcParam)) {
+            serveRequest(request, handler, context);
+        }
+        dropReference(request);
+    } while (waitForMessage(pipe, 0, 0, &request) == RPVC_OK);
+    return RPVC_OK;
 }
@@ -0,0 +1,422 @@
+/* Software Bus datagram bridge (POSIX hosts) */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "SoftwareBusBridge.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+
+#if defined(__linux__)
+    #define SB_BRIDGE_USE_MMSG 1
+#else
+    #define SB_BRIDGE_USE_MMSG 0
+#endif
+
+/*
+ * Datagram: 4-byte magic, then records of
+ *   [messageId: u16][length: u16][payload: length bytes]
+ * all in network byte order.
+ */
+#define SB_BRIDGE_MAGIC 0x52534231U // "RSB1"
+#define SB_BRIDGE_HEADER_SIZE 4U
+#define SB_BRIDGE_RECORD_HEADER_SIZE 4U
+#define SB_BRIDGE_DRAIN_CHUNK 16U
+
+static uint64_t monotonicUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+static void putU16(uint8_t *out, uint16_t value)
+{
+    out[0] = (uint8_t)(value >> 8);
+    out[1] = (uint8_t)value;
+}
+
+static uint16_t getU16(const uint8_t *in)
+{
+    return (uint16_t)(((uint16_t)in[0] << 8) | in[1]);
+}
+
+static bool parseAddress(RPVC_SbBridgeTransport_t transport, const char *text, struct sockaddr_storage *out, socklen_t *outLength)
+{
+    memset(out, 0, sizeof(*out));
+
+    if (transport == RPVC_SB_BRIDGE_UNIX) {
+        struct sockaddr_un *addr = (struct sockaddr_un *)out;
+        size_t length = strlen(text);
+        if (length == 0 || length >= sizeof(addr->sun_path)) {
+            return false;
+        }
+        addr->sun_family = AF_UNIX;
+        memcpy(addr->sun_path, text, length + 1);
+        *outLength = (socklen_t)sizeof(*addr);
+        return true;
+    }
+
+    const char *colon = strrchr(text, ':');
+    if (colon == NULL || (size_t)(colon - text) >= INET_ADDRSTRLEN) {
+        return false;
+    }
+    char host[INET_ADDRSTRLEN];
+    memcpy(host, text, (size_t)(colon - text));
+    host[colon - text] = '\0';
+
+    char *end = NULL;
+    unsigned long port = strtoul(colon + 1, &end, 10);
+    if (end == colon + 1 || *end != '\0' || port > 65535U) {
+        return false;
+    }
+
+    struct sockaddr_in *addr = (struct sockaddr_in *)out;
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &addr->sin_addr) != 1) {
+        return false;
+    }
+    *outLength = (socklen_t)sizeof(*addr);
+    return true;
+}
+
+// Connecting makes the kernel drop datagrams from anyone but the peer. A Unix
+// peer that is not bound yet cannot be connected to, so this is retried on
+// every poll until it works.
+static void connectPeer(RPVC_SbBridge_t *bridge)
+{
+    if (!bridge->connected && connect(bridge->fd, (const struct sockaddr *)&bridge->peer, bridge->peerLength) == 0) {
+        bridge->connected = true;
+    }
+}
+
+// Source check for datagrams queued before the socket was connected
+static bool isFromPeer(const RPVC_SbBridge_t *bridge, const struct sockaddr_storage *source, socklen_t sourceLength)
+{
+    if (bridge->transport == RPVC_SB_BRIDGE_UNIX) {
+        const struct sockaddr_un *from = (const struct sockaddr_un *)source;
+        const struct sockaddr_un *peer = (const struct sockaddr_un *)&bridge->peer;
+        return sourceLength > offsetof(struct sockaddr_un, sun_path) && from->sun_family == AF_UNIX &&
+               strncmp(from->sun_path, peer->sun_path, sizeof(from->sun_path)) == 0;
+    }
+    const struct sockaddr_in *from = (const struct sockaddr_in *)source;
+    const struct sockaddr_in *peer = (const struct sockaddr_in *)&bridge->peer;
+    return sourceLength >= (socklen_t)sizeof(*from) && from->sin_family == AF_INET &&
+           from->sin_port == peer->sin_port && from->sin_addr.s_addr == peer->sin_addr.s_addr;
+}
+
+RPVC_Status_t RPVC_SB_BridgeOpen(RPVC_SbBridge_t *bridge, const RPVC_SbBridgeConfig_t *config)
+{
+    if (bridge == NULL || config == NULL || config->localAddress == NULL || config->peerAddress == NULL ||
+        (config->messageIds == NULL && config->messageIdCount > 0) ||
+        config->transport > RPVC_SB_BRIDGE_UNIX || config->maxDatagramSize > RPVC_SB_BRIDGE_MAX_DATAGRAM) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    size_t maxDatagramSize = config->maxDatagramSize != 0 ? config->maxDatagramSize : RPVC_SB_BRIDGE_MAX_DATAGRAM;
+    if (maxDatagramSize < SB_BRIDGE_HEADER_SIZE + SB_BRIDGE_RECORD_HEADER_SIZE + RPVC_SB_MAX_PAYLOAD_SIZE) {
+        return RPVC_ERR_INVALID_ARG; // every message must fit a datagram on its own
+    }
+
+    memset(bridge, 0, sizeof(*bridge));
+    bridge->fd = -1;
+
+    struct sockaddr_storage local;
+    socklen_t localLength = 0;
+    if (!parseAddress(config->transport, config->localAddress, &local, &localLength) ||
+        !parseAddress(config->transport, config->peerAddress, &bridge->peer, &bridge->peerLength)) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    int fd = socket(config->transport == RPVC_SB_BRIDGE_UNIX ? AF_UNIX : AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return RPVC_ERR_NO_RESOURCE;
+    }
+
+    if (config->transport == RPVC_SB_BRIDGE_UNIX) {
+        (void)unlink(config->localAddress); // stale socket file from an earlier run
+    }
+    if (bind(fd, (const struct sockaddr *)&local, localLength) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        close(fd);
+        return RPVC_ERR_NO_RESOURCE;
+    }
+
+    for (size_t i = 0; i < config->messageIdCount; i++) {
+        RPVC_Status_t status = RPVC_SB_Subscribe(config->pipeId, config->messageIds[i]);
+        if (status != RPVC_OK) {
+            // leave the bus as it was
+            while (i-- > 0) {
+                (void)RPVC_SB_Unsubscribe(config->pipeId, config->messageIds[i]);
+            }
+            (void)RPVC_SB_Flush(config->pipeId);
+            close(fd);
+            if (config->transport == RPVC_SB_BRIDGE_UNIX) {
+                (void)unlink(config->localAddress);
+            }
+            return status;
+        }
+    }
+
+    bridge->fd = fd;
+    bridge->transport = config->transport;
+    bridge->pipeId = config->pipeId;
+    bridge->flushDeadlineUs = config->flushDeadlineUs;
+    bridge->maxDatagramSize = maxDatagramSize;
+    if (config->transport == RPVC_SB_BRIDGE_UNIX) {
+        strncpy(bridge->localPath, config->localAddress, sizeof(bridge->localPath) - 1);
+    }
+    connectPeer(bridge);
+    return RPVC_OK;
+}
+
+static RPVC_Status_t sendPending(RPVC_SbBridge_t *bridge)
+{
+    uint32_t count = bridge->txCount;
+    if (count == 0) {
+        return RPVC_OK;
+    }
+
+#if SB_BRIDGE_USE_MMSG
+    struct mmsghdr messages[RPVC_SB_BRIDGE_BATCH];
+    struct iovec vectors[RPVC_SB_BRIDGE_BATCH];
+    memset(messages, 0, sizeof(messages));
+    for (uint32_t i = 0; i < count; i++) {
+        vectors[i].iov_base = bridge->txBuffers[i];
+        vectors[i].iov_len = bridge->txLengths[i];
+        // a connected socket already has the peer (Unix sockets refuse it twice)
+        messages[i].msg_hdr.msg_name = bridge->connected ? NULL : &bridge->peer;
+        messages[i].msg_hdr.msg_namelen = bridge->connected ? 0 : bridge->peerLength;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    uint32_t sent = 0;
+    while (sent < count) {
+        int result = sendmmsg(bridge->fd, &messages[sent], count - sent, 0);
+        if (result <= 0) {
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        sent += (uint32_t)result;
+    }
+#else
+    uint32_t sent = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (sendto(bridge->fd, bridge->txBuffers[i], bridge->txLengths[i], 0,
+                   bridge->connected ? NULL : (const struct sockaddr *)&bridge->peer,
+                   bridge->connected ? 0 : bridge->peerLength) >= 0) {
+            sent++;
+        }
+    }
+#endif
+
+    // unreliable transport: a refused datagram is counted, not retried
+    bridge->stats.datagramsSent += sent;
+    bridge->stats.sendErrors += count - sent;
+    bridge->txCount = 0;
+    bridge->txLengths[0] = 0;
+    return RPVC_OK;
+}
+
+// Callers keep txCount below RPVC_SB_BRIDGE_BATCH outside of sendPending
+static void closeOpenDatagram(RPVC_SbBridge_t *bridge)
+{
+    if (bridge->txLengths[bridge->txCount] > SB_BRIDGE_HEADER_SIZE) {
+        bridge->txCount++;
+        if (bridge->txCount < RPVC_SB_BRIDGE_BATCH) {
+            bridge->txLengths[bridge->txCount] = 0;
+        }
+    }
+}
+
+static void appendRecord(RPVC_SbBridge_t *bridge, RPVC_SbMsgId_t messageId, const uint8_t *payload, size_t size)
+{
+    size_t recordSize = SB_BRIDGE_RECORD_HEADER_SIZE + size;
+    if (bridge->txLengths[bridge->txCount] + recordSize > bridge->maxDatagramSize) {
+        closeOpenDatagram(bridge);
+        if (bridge->txCount == RPVC_SB_BRIDGE_BATCH) {
+            (void)sendPending(bridge);
+        }
+    }
+
+    uint8_t *datagram = bridge->txBuffers[bridge->txCount];
+    size_t length = bridge->txLengths[bridge->txCount];
+    if (length == 0) {
+        datagram[0] = (uint8_t)(SB_BRIDGE_MAGIC >> 24);
+        datagram[1] = (uint8_t)(SB_BRIDGE_MAGIC >> 16);
+        datagram[2] = (uint8_t)(SB_BRIDGE_MAGIC >> 8);
+        datagram[3] = (uint8_t)SB_BRIDGE_MAGIC;
+        length = SB_BRIDGE_HEADER_SIZE;
+        if (bridge->txCount == 0) {
+            bridge->openSinceUs = monotonicUs();
+        }
+    }
+
+    putU16(&datagram[length], messageId);
+    putU16(&datagram[length + 2], (uint16_t)size);
+    memcpy(&datagram[length + SB_BRIDGE_RECORD_HEADER_SIZE], payload, size);
+    bridge->txLengths[bridge->txCount] = length + recordSize;
+    bridge->stats.messagesSent++;
+}
+
+static void forwardPipe(RPVC_SbBridge_t *bridge)
+{
+    RPVC_SbMsgHandle_t handles[SB_BRIDGE_DRAIN_CHUNK];
+    size_t count = 0;
+    while (RPVC_SB_ReceiveBatch(bridge->pipeId, handles, SB_BRIDGE_DRAIN_CHUNK, &count) == RPVC_OK) {
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t *payload = NULL;
+            size_t size = 0;
+            RPVC_SbMsgId_t messageId = 0;
+            (void)RPVC_SB_GetMessagePayload(handles[i], &payload, &size);
+            (void)RPVC_SB_GetMessageId(handles[i], &messageId);
+            appendRecord(bridge, messageId, payload, size);
+            (void)RPVC_SB_ReleaseMessage(handles[i]);
+        }
+    }
+}
+
+static void republishDatagram(RPVC_SbBridge_t *bridge, const uint8_t *datagram, size_t length)
+{
+    if (length < SB_BRIDGE_HEADER_SIZE ||
+        ((uint32_t)getU16(datagram) << 16 | getU16(&datagram[2])) != SB_BRIDGE_MAGIC) {
+        bridge->stats.malformedDatagrams++;
+        return;
+    }
+    bridge->stats.datagramsReceived++;
+
+    size_t offset = SB_BRIDGE_HEADER_SIZE;
+    while (offset + SB_BRIDGE_RECORD_HEADER_SIZE <= length) {
+        RPVC_SbMsgId_t messageId = getU16(&datagram[offset]);
+        size_t size = getU16(&datagram[offset + 2]);
+        offset += SB_BRIDGE_RECORD_HEADER_SIZE;
+        if (offset + size > length) {
+            bridge->stats.malformedDatagrams++;
+            return;
+        }
+
+        RPVC_SbMsgHandle_t handle = NULL;
+        if (RPVC_SB_CreateMessage(messageId, &datagram[offset], size, &handle) == RPVC_OK) {
+            // remote traffic must not loop back out through this bridge
+            (void)RPVC_SB_PublishExcluding(handle, bridge->pipeId);
+            (void)RPVC_SB_ReleaseMessage(handle);
+            bridge->stats.messagesReceived++;
+        }
+        offset += size;
+    }
+}
+
+static void receivePeer(RPVC_SbBridge_t *bridge)
+{
+#if SB_BRIDGE_USE_MMSG
+    struct mmsghdr messages[RPVC_SB_BRIDGE_BATCH];
+    struct iovec vectors[RPVC_SB_BRIDGE_BATCH];
+    struct sockaddr_storage sources[RPVC_SB_BRIDGE_BATCH];
+    while (true) {
+        memset(messages, 0, sizeof(messages));
+        for (uint32_t i = 0; i < RPVC_SB_BRIDGE_BATCH; i++) {
+            vectors[i].iov_base = bridge->rxBuffers[i];
+            vectors[i].iov_len = RPVC_SB_BRIDGE_MAX_DATAGRAM;
+            messages[i].msg_hdr.msg_name = &sources[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int received = recvmmsg(bridge->fd, messages, RPVC_SB_BRIDGE_BATCH, MSG_DONTWAIT, NULL);
+        if (received <= 0) {
+            return;
+        }
+        for (int i = 0; i < received; i++) {
+            if (isFromPeer(bridge, &sources[i], messages[i].msg_hdr.msg_namelen)) {
+                republishDatagram(bridge, bridge->rxBuffers[i], messages[i].msg_len);
+            }
+            else {
+                bridge->stats.foreignDatagrams++;
+            }
+        }
+    }
+#else
+    while (true) {
+        struct sockaddr_storage source;
+        socklen_t sourceLength = sizeof(source);
+        ssize_t received = recvfrom(bridge->fd, bridge->rxBuffers[0], RPVC_SB_BRIDGE_MAX_DATAGRAM, MSG_DONTWAIT,
+                                    (struct sockaddr *)&source, &sourceLength);
+        if (received < 0) {
+            return;
+        }
+        if (isFromPeer(bridge, &source, sourceLength)) {
+            republishDatagram(bridge, bridge->rxBuffers[0], (size_t)received);
+        }
+        else {
+            bridge->stats.foreignDatagrams++;
+        }
+    }
+#endif
+}
+
+RPVC_Status_t RPVC_SB_BridgePoll(RPVC_SbBridge_t *bridge)
+{
+    if (bridge == NULL || bridge->fd < 0) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    connectPeer(bridge);
+    forwardPipe(bridge);
+
+    bool hasPending = bridge->txCount > 0 || bridge->txLengths[0] > SB_BRIDGE_HEADER_SIZE;
+    if (hasPending && monotonicUs() - bridge->openSinceUs >= bridge->flushDeadlineUs) {
+        closeOpenDatagram(bridge);
+        (void)sendPending(bridge);
+    }
+
+    receivePeer(bridge);
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_BridgeFlush(RPVC_SbBridge_t *bridge)
+{
+    if (bridge == NULL || bridge->fd < 0) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    forwardPipe(bridge);
+    closeOpenDatagram(bridge);
+    return sendPending(bridge);
+}
+
+RPVC_Status_t RPVC_SB_BridgeGetStats(const RPVC_SbBridge_t *bridge, RPVC_SbBridgeStats_t *outStats)
+{
+    if (bridge == NULL || outStats == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outStats = bridge->stats;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_BridgeClose(RPVC_SbBridge_t *bridge)
+{
+    if (bridge == NULL || bridge->fd < 0) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    (void)RPVC_SB_BridgeFlush(bridge);
+    (void)RPVC_SB_Flush(bridge->pipeId); // releases anything still queued and deactivates the pipe
+    close(bridge->fd);
+    bridge->fd = -1;
+    if (bridge->transport == RPVC_SB_BRIDGE_UNIX && bridge->localPath[0] != '\0') {
+        (void)unlink(bridge->localPath);
+    }
+    return RPVC_OK;
+}
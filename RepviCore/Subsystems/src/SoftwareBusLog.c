@@ -0,0 +1,534 @@
+/* Software Bus record and replay (POSIX hosts) */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "SoftwareBusLog.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Segment: header, records, then (once closed) the index and a trailer.
+ * Records are 8-byte aligned so they can be read in place from the mapping.
+ * Records and the index carry monotonic time, so a wall clock step cannot
+ * reorder them or stall a paced replay; only the header holds the wall time,
+ * next to the monotonic time of the same instant, for seeking by wall time.
+ * Everything is in host byte order; logs are replayed on the machine kind
+ * that wrote them.
+ */
+#define SB_LOG_MAGIC 0x4C425352U       // "RSBL"
+#define SB_LOG_INDEX_MAGIC 0x58425352U // "RSBX"
+#define SB_LOG_VERSION 2U
+#define SB_LOG_DRAIN_CHUNK 16U
+#define SB_LOG_PUBLISH_CHUNK 16U
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t segmentNumber;
+    uint32_t reserved;
+    uint64_t startTimeUs;      // wall clock when the segment was opened
+    uint64_t startMonotonicUs; // the same instant on the monotonic clock; no record is older
+} SbLogSegmentHeader_t;
+
+typedef struct {
+    uint64_t timeUs;
+    RPVC_SbMsgId_t messageId;
+    uint16_t length;
+    uint32_t reserved;
+    // payload, padded to 8 bytes
+} SbLogRecord_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t entryCount;
+    uint64_t indexOffset;
+} SbLogTrailer_t;
+
+_Static_assert(sizeof(SbLogSegmentHeader_t) % 8 == 0 && sizeof(SbLogRecord_t) == 16 && sizeof(SbLogTrailer_t) == 16,
+               "log structures must keep records 8-byte aligned");
+
+static uint64_t wallClockUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+static uint64_t monotonicUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+static size_t recordSize(size_t payloadLength)
+{
+    return sizeof(SbLogRecord_t) + ((payloadLength + 7U) & ~(size_t)7U);
+}
+
+static bool segmentPath(char *out, size_t outSize, const char *basePath, uint32_t segmentNumber)
+{
+    int length = snprintf(out, outSize, "%s.%04u", basePath, (unsigned)segmentNumber);
+    return length > 0 && (size_t)length < outSize;
+}
+
+static bool writeAll(int fd, const void *data, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    while (length > 0) {
+        ssize_t written = write(fd, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+/* ---------------------------------------------------------------- recorder */
+
+static RPVC_Status_t openSegment(RPVC_SbRecorder_t *recorder)
+{
+    char path[RPVC_SB_LOG_PATH_MAX + 8];
+    if (recorder->segmentNumber >= RPVC_SB_LOG_MAX_SEGMENTS ||
+        !segmentPath(path, sizeof(path), recorder->basePath, recorder->segmentNumber)) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return RPVC_ERR_NO_RESOURCE;
+    }
+
+    SbLogSegmentHeader_t header = {SB_LOG_MAGIC, SB_LOG_VERSION, (uint16_t)sizeof(SbLogSegmentHeader_t),
+                                   recorder->segmentNumber, 0, wallClockUs(), monotonicUs()};
+    if (!writeAll(fd, &header, sizeof(header))) {
+        close(fd);
+        return RPVC_ERR_NO_RESOURCE;
+    }
+
+    recorder->fd = fd;
+    recorder->segmentOffset = sizeof(header);
+    recorder->indexCount = 0;
+    return RPVC_OK;
+}
+
+static void writeBuffer(RPVC_SbRecorder_t *recorder)
+{
+    if (recorder->bufferLength == 0) {
+        return;
+    }
+    if (writeAll(recorder->fd, recorder->buffer, recorder->bufferLength)) {
+        recorder->segmentOffset += recorder->bufferLength;
+    }
+    else {
+        // the index may point past the end now; the player stops at the file size
+        recorder->writeErrors++;
+    }
+    recorder->bufferLength = 0;
+}
+
+static void closeSegment(RPVC_SbRecorder_t *recorder)
+{
+    writeBuffer(recorder);
+
+    SbLogTrailer_t trailer = {SB_LOG_INDEX_MAGIC, recorder->indexCount, recorder->segmentOffset};
+    if (!writeAll(recorder->fd, recorder->index, recorder->indexCount * sizeof(RPVC_SbLogIndexEntry_t)) ||
+        !writeAll(recorder->fd, &trailer, sizeof(trailer))) {
+        recorder->writeErrors++;
+    }
+    close(recorder->fd);
+    recorder->fd = -1;
+}
+
+static void appendRecord(RPVC_SbRecorder_t *recorder, uint64_t timeUs, RPVC_SbMsgId_t messageId, const uint8_t *payload, size_t length)
+{
+    size_t size = recordSize(length);
+    if (recorder->segmentOffset + recorder->bufferLength + size > recorder->segmentSize) {
+        closeSegment(recorder);
+        recorder->segmentNumber++;
+        if (openSegment(recorder) != RPVC_OK) {
+            recorder->writeErrors++;
+            return;
+        }
+    }
+    else if (recorder->bufferLength + size > RPVC_SB_LOG_BUFFER_SIZE) {
+        writeBuffer(recorder);
+    }
+
+    // one index entry per write keeps the index small and a seek scan short
+    if (recorder->bufferLength == 0 && recorder->indexCount < RPVC_SB_LOG_MAX_INDEX) {
+        recorder->index[recorder->indexCount].timeUs = timeUs;
+        recorder->index[recorder->indexCount].offset = recorder->segmentOffset;
+        recorder->indexCount++;
+    }
+
+    SbLogRecord_t record = {timeUs, messageId, (uint16_t)length, 0};
+    memcpy(&recorder->buffer[recorder->bufferLength], &record, sizeof(record));
+    uint8_t *data = &recorder->buffer[recorder->bufferLength + sizeof(SbLogRecord_t)];
+    memcpy(data, payload, length);
+    memset(data + length, 0, size - sizeof(SbLogRecord_t) - length);
+    recorder->bufferLength += size;
+}
+
+RPVC_Status_t RPVC_SB_RecorderOpen(RPVC_SbRecorder_t *recorder, const RPVC_SbRecorderConfig_t *config)
+{
+    if (recorder == NULL || config == NULL || config->basePath == NULL ||
+        (config->messageIds == NULL && config->messageIdCount > 0) ||
+        strlen(config->basePath) >= RPVC_SB_LOG_PATH_MAX || config->segmentSize > RPVC_SB_LOG_MAX_SEGMENT_SIZE) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    uint32_t segmentSize = config->segmentSize != 0 ? config->segmentSize : RPVC_SB_LOG_DEFAULT_SEGMENT_SIZE;
+    if (segmentSize < sizeof(SbLogSegmentHeader_t) + recordSize(RPVC_SB_MAX_PAYLOAD_SIZE)) {
+        return RPVC_ERR_INVALID_ARG; // every message must fit a segment on its own
+    }
+
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->fd = -1;
+    memcpy(recorder->basePath, config->basePath, strlen(config->basePath) + 1);
+    recorder->pipeId = config->pipeId;
+    recorder->segmentSize = segmentSize;
+
+    RPVC_Status_t status = openSegment(recorder);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    for (size_t i = 0; i < config->messageIdCount; i++) {
+        status = RPVC_SB_Subscribe(config->pipeId, config->messageIds[i]);
+        if (status != RPVC_OK) {
+            // leave the bus and the directory as they were
+            while (i-- > 0) {
+                (void)RPVC_SB_Unsubscribe(config->pipeId, config->messageIds[i]);
+            }
+            (void)RPVC_SB_Flush(config->pipeId);
+            close(recorder->fd);
+            recorder->fd = -1;
+            char path[RPVC_SB_LOG_PATH_MAX + 8];
+            if (segmentPath(path, sizeof(path), recorder->basePath, 0)) {
+                (void)unlink(path);
+            }
+            recorder->basePath[0] = '\0';
+            return status;
+        }
+    }
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_RecorderPoll(RPVC_SbRecorder_t *recorder)
+{
+    if (recorder == NULL || recorder->fd < 0) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    RPVC_SbMsgHandle_t handles[SB_LOG_DRAIN_CHUNK];
+    size_t count = 0;
+    while (RPVC_SB_ReceiveBatch(recorder->pipeId, handles, SB_LOG_DRAIN_CHUNK, &count) == RPVC_OK) {
+        uint64_t nowUs = monotonicUs();
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t *payload = NULL;
+            size_t size = 0;
+            RPVC_SbMsgId_t messageId = 0;
+            (void)RPVC_SB_GetMessagePayload(handles[i], &payload, &size);
+            (void)RPVC_SB_GetMessageId(handles[i], &messageId);
+            if (recorder->fd >= 0) {
+                appendRecord(recorder, nowUs, messageId, payload, size);
+            }
+            (void)RPVC_SB_ReleaseMessage(handles[i]);
+        }
+    }
+    return recorder->fd >= 0 ? RPVC_OK : RPVC_ERR_NO_RESOURCE;
+}
+
+RPVC_Status_t RPVC_SB_RecorderFlush(RPVC_SbRecorder_t *recorder)
+{
+    RPVC_Status_t status = RPVC_SB_RecorderPoll(recorder);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    uint32_t writeErrors = recorder->writeErrors;
+    writeBuffer(recorder);
+    return recorder->writeErrors == writeErrors ? RPVC_OK : RPVC_ERR_NO_RESOURCE;
+}
+
+RPVC_Status_t RPVC_SB_RecorderClose(RPVC_SbRecorder_t *recorder)
+{
+    if (recorder == NULL || recorder->basePath[0] == '\0') {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    // the segment may already be gone if a rotation failed
+    if (recorder->fd >= 0) {
+        (void)RPVC_SB_RecorderPoll(recorder);
+        closeSegment(recorder);
+    }
+    (void)RPVC_SB_Flush(recorder->pipeId); // releases anything still queued and deactivates the pipe
+    recorder->basePath[0] = '\0';
+    return recorder->writeErrors == 0 ? RPVC_OK : RPVC_ERR_NO_RESOURCE;
+}
+
+/* ------------------------------------------------------------------ player */
+
+static void unmapSegment(RPVC_SbPlayer_t *player)
+{
+    if (player->map != NULL) {
+        (void)munmap((void *)player->map, player->mapSize);
+        player->map = NULL;
+    }
+    player->mapSize = 0;
+    player->recordsEnd = 0;
+    player->index = NULL;
+    player->indexCount = 0;
+    player->position = 0;
+}
+
+static RPVC_Status_t readSegmentHeader(const char *basePath, uint32_t segmentNumber, SbLogSegmentHeader_t *outHeader)
+{
+    char path[RPVC_SB_LOG_PATH_MAX + 8];
+    if (!segmentPath(path, sizeof(path), basePath, segmentNumber)) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return RPVC_ERR_NOT_FOUND;
+    }
+    ssize_t got = pread(fd, outHeader, sizeof(*outHeader), 0);
+    close(fd);
+    if (got != (ssize_t)sizeof(*outHeader) || outHeader->magic != SB_LOG_MAGIC || outHeader->version != SB_LOG_VERSION) {
+        return RPVC_ERR_INTEGRITY;
+    }
+    return RPVC_OK;
+}
+
+static RPVC_Status_t mapSegment(RPVC_SbPlayer_t *player, uint32_t segmentNumber)
+{
+    unmapSegment(player);
+    player->segmentNumber = segmentNumber;
+
+    char path[RPVC_SB_LOG_PATH_MAX + 8];
+    if (segmentNumber >= RPVC_SB_LOG_MAX_SEGMENTS || !segmentPath(path, sizeof(path), player->basePath, segmentNumber)) {
+        return RPVC_ERR_NOT_FOUND;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return RPVC_ERR_NOT_FOUND;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SbLogSegmentHeader_t)) {
+        close(fd);
+        return RPVC_ERR_INTEGRITY;
+    }
+    size_t size = (size_t)info.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return RPVC_ERR_NO_RESOURCE;
+    }
+    (void)madvise(map, size, MADV_SEQUENTIAL);
+
+    const SbLogSegmentHeader_t *header = (const SbLogSegmentHeader_t *)map;
+    if (header->magic != SB_LOG_MAGIC || header->version != SB_LOG_VERSION || header->headerSize != sizeof(*header)) {
+        (void)munmap(map, size);
+        return RPVC_ERR_INTEGRITY;
+    }
+
+    player->map = (const uint8_t *)map;
+    player->mapSize = size;
+    player->recordsEnd = size;
+    player->position = sizeof(*header);
+
+    // a segment that was never closed has no trailer and plays to the end of the file
+    if (size >= sizeof(*header) + sizeof(SbLogTrailer_t)) {
+        const SbLogTrailer_t *trailer = (const SbLogTrailer_t *)(player->map + size - sizeof(SbLogTrailer_t));
+        uint64_t indexBytes = (uint64_t)trailer->entryCount * sizeof(RPVC_SbLogIndexEntry_t);
+        if (trailer->magic == SB_LOG_INDEX_MAGIC && trailer->indexOffset >= sizeof(*header) &&
+            trailer->indexOffset + indexBytes + sizeof(SbLogTrailer_t) == size) {
+            player->recordsEnd = (size_t)trailer->indexOffset;
+            player->index = (const RPVC_SbLogIndexEntry_t *)(player->map + trailer->indexOffset);
+            player->indexCount = trailer->entryCount;
+        }
+    }
+    return RPVC_OK;
+}
+
+// The record at the current position, or NULL at the end of the segment (or a torn record)
+static const SbLogRecord_t *currentRecord(const RPVC_SbPlayer_t *player)
+{
+    if (player->map == NULL || player->position + sizeof(SbLogRecord_t) > player->recordsEnd) {
+        return NULL;
+    }
+    const SbLogRecord_t *record = (const SbLogRecord_t *)(player->map + player->position);
+    if (record->length > RPVC_SB_MAX_PAYLOAD_SIZE || player->position + recordSize(record->length) > player->recordsEnd) {
+        return NULL;
+    }
+    return record;
+}
+
+// Next record across segments, NULL once the log is exhausted
+static const SbLogRecord_t *nextRecord(RPVC_SbPlayer_t *player)
+{
+    while (player->map != NULL) {
+        const SbLogRecord_t *record = currentRecord(player);
+        if (record != NULL) {
+            return record;
+        }
+        if (mapSegment(player, player->segmentNumber + 1) != RPVC_OK) {
+            unmapSegment(player);
+        }
+    }
+    return NULL;
+}
+
+RPVC_Status_t RPVC_SB_PlayerOpen(RPVC_SbPlayer_t *player, const char *basePath, RPVC_SbPlayMode_t mode)
+{
+    if (player == NULL || basePath == NULL || strlen(basePath) >= RPVC_SB_LOG_PATH_MAX || mode > RPVC_SB_PLAY_FAST) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    memset(player, 0, sizeof(*player));
+    memcpy(player->basePath, basePath, strlen(basePath) + 1);
+    player->mode = mode;
+    return mapSegment(player, 0);
+}
+
+RPVC_Status_t RPVC_SB_PlayerSeek(RPVC_SbPlayer_t *player, uint64_t timeUs)
+{
+    if (player == NULL || player->basePath[0] == '\0') {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    // the last segment that started at or before timeUs
+    uint32_t segmentNumber = 0;
+    SbLogSegmentHeader_t header;
+    while (segmentNumber + 1 < RPVC_SB_LOG_MAX_SEGMENTS &&
+           readSegmentHeader(player->basePath, segmentNumber + 1, &header) == RPVC_OK && header.startTimeUs <= timeUs) {
+        segmentNumber++;
+    }
+
+    RPVC_Status_t status = mapSegment(player, segmentNumber);
+    if (status != RPVC_OK) {
+        return status;
+    }
+
+    // records are on the monotonic clock: translate through the segment header
+    const SbLogSegmentHeader_t *mapped = (const SbLogSegmentHeader_t *)player->map;
+    uint64_t wallUs = timeUs;
+    timeUs = mapped->startMonotonicUs;
+    if (wallUs > mapped->startTimeUs) {
+        timeUs += wallUs - mapped->startTimeUs;
+    }
+
+    // binary search for the last indexed write starting at or before timeUs, then scan
+    if (player->indexCount > 0 && player->index[0].timeUs <= timeUs) {
+        uint32_t low = 0;
+        uint32_t high = player->indexCount;
+        while (high - low > 1) {
+            uint32_t mid = low + (high - low) / 2;
+            if (player->index[mid].timeUs <= timeUs) {
+                low = mid;
+            }
+            else {
+                high = mid;
+            }
+        }
+        if (player->index[low].offset < player->recordsEnd) {
+            player->position = (size_t)player->index[low].offset;
+        }
+    }
+
+    player->anchored = false;
+    const SbLogRecord_t *record = nextRecord(player);
+    while (record != NULL && record->timeUs < timeUs) {
+        player->position += recordSize(record->length);
+        record = nextRecord(player);
+    }
+    return record != NULL ? RPVC_OK : RPVC_ERR_OUT_OF_RANGE;
+}
+
+RPVC_Status_t RPVC_SB_PlayerPoll(RPVC_SbPlayer_t *player, size_t maxRecords, size_t *outCount)
+{
+    if (player == NULL || outCount == NULL || maxRecords == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outCount = 0;
+    const SbLogRecord_t *record = nextRecord(player);
+    if (record == NULL) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    uint64_t nowUs = monotonicUs();
+    if (!player->anchored) {
+        player->anchorLogUs = record->timeUs;
+        player->anchorWallUs = nowUs;
+        player->anchored = true;
+    }
+
+    // handed to RPVC_SB_PublishBatch in chunks; the bus takes the message references
+    RPVC_SbMsgHandle_t handles[SB_LOG_PUBLISH_CHUNK];
+    size_t chunk = 0;
+    size_t published = 0;
+    while (record != NULL && published + chunk < maxRecords) {
+        if (player->mode == RPVC_SB_PLAY_RECORDED_TIMING && record->timeUs > player->anchorLogUs &&
+            record->timeUs - player->anchorLogUs > nowUs - player->anchorWallUs) {
+            break; // not due yet
+        }
+
+        const uint8_t *payload = (const uint8_t *)(record + 1);
+        RPVC_Status_t status = RPVC_SB_CreateMessage(record->messageId, payload, record->length, &handles[chunk]);
+        if (status == RPVC_ERR_NO_MEMORY) {
+            break; // pool exhausted: retry this record on the next poll
+        }
+        player->position += recordSize(record->length);
+        if (status == RPVC_OK) {
+            chunk++;
+        }
+
+        if (chunk == SB_LOG_PUBLISH_CHUNK) {
+            (void)RPVC_SB_PublishBatch(handles, chunk);
+            for (size_t i = 0; i < chunk; i++) {
+                (void)RPVC_SB_ReleaseMessage(handles[i]);
+            }
+            published += chunk;
+            chunk = 0;
+        }
+        record = nextRecord(player);
+    }
+
+    if (chunk > 0) {
+        (void)RPVC_SB_PublishBatch(handles, chunk);
+        for (size_t i = 0; i < chunk; i++) {
+            (void)RPVC_SB_ReleaseMessage(handles[i]);
+        }
+        published += chunk;
+    }
+
+    *outCount = published;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_PlayerClose(RPVC_SbPlayer_t *player)
+{
+    if (player == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    unmapSegment(player);
+    player->basePath[0] = '\0';
+    return RPVC_OK;
+}
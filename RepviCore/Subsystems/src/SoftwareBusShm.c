@@ -0,0 +1,457 @@
+/* Shared-memory Software Bus transport (POSIX hosts) */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "SoftwareBusShm.h"
+#include "RPVC_CompilerAbstraction.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+    #define SB_SHM_USE_FUTEX 1
+#else
+    #define SB_SHM_USE_FUTEX 0
+#endif
+
+#define SB_SHM_MAGIC 0x52534248U // "RSBH"
+#define SB_SHM_LAYOUT_VERSION 1U
+#define SB_SHM_NO_BLOCK 0xFFFFU
+#define SB_SHM_TAG_STEP 0x10000U // free-list ABA tag lives in the upper 16 bits
+#define SB_SHM_CACHE_LINE 64
+
+_Static_assert(RPVC_SB_SHM_BLOCKS < SB_SHM_NO_BLOCK, "block indices are 16-bit");
+_Static_assert((RPVC_SB_SHM_PIPE_DEPTH & (RPVC_SB_SHM_PIPE_DEPTH - 1)) == 0, "pipe depth must be a power of two");
+_Static_assert(RPVC_SB_MAX_PIPES <= 32, "pipe sets are tracked as 32-bit masks");
+
+// Everything below is shared between processes: indices only, no pointers.
+
+typedef struct {
+    uint32_t next;     // free-list link
+    uint32_t refCount; // atomic: publisher + one per queued copy
+    RPVC_SbMsgId_t messageId;
+    uint16_t len;
+    uint8_t payload[RPVC_SB_MAX_PAYLOAD_SIZE];
+} SbShmBlock_t;
+
+typedef struct {
+    uint32_t sequence; // atomic: cell is writable at pos, readable at pos + 1
+    uint32_t block;
+} SbShmCell_t;
+
+// Bounded multi-producer ring (Vyukov) with a single receiver
+typedef struct {
+    uint32_t enqueuePos; // atomic: shared by publishers in every process
+    uint8_t padProducer[SB_SHM_CACHE_LINE - sizeof(uint32_t)];
+    uint32_t dequeuePos; // receiver only
+    uint32_t wakeSeq;    // atomic: futex word, bumped when a receiver sleeps
+    uint32_t waiters;    // atomic
+    uint32_t dropCount;  // atomic
+    uint8_t padReceiver[SB_SHM_CACHE_LINE - 4 * sizeof(uint32_t)];
+    SbShmCell_t cells[RPVC_SB_SHM_PIPE_DEPTH];
+} SbShmPipe_t;
+
+typedef struct {
+    uint32_t magic; // stored last by the creator
+    uint32_t version;
+    uint32_t size;
+    uint32_t freeTop; // atomic: (tag << 16) | index of the first free block
+    uint32_t routes[RPVC_SB_MAX_MESSAGE_ID]; // atomic: subscribed pipes per message ID
+    SbShmPipe_t pipes[RPVC_SB_MAX_PIPES];
+    SbShmBlock_t blocks[RPVC_SB_SHM_BLOCKS];
+} SbShmSegment_t;
+
+static SbShmSegment_t *segmentOf(const RPVC_SbShm_t *bus)
+{
+    return (bus != NULL) ? (SbShmSegment_t *)bus->segment : NULL;
+}
+
+#if SB_SHM_USE_FUTEX
+/* Shared (not private) futex: waker and sleeper may be different processes */
+static void futexWait(uint32_t *addr, uint32_t expected, const struct timespec *relTimeout)
+{
+    (void)syscall(SYS_futex, addr, FUTEX_WAIT, expected, relTimeout, NULL, 0);
+}
+
+static void futexWake(uint32_t *addr)
+{
+    (void)syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+#endif
+
+static uint32_t popFreeBlock(SbShmSegment_t *seg)
+{
+    while (true) {
+        uint32_t top = RPVC_ATOMIC_LOAD(&seg->freeTop);
+        uint32_t index = top & SB_SHM_NO_BLOCK;
+        if (index == SB_SHM_NO_BLOCK) {
+            return SB_SHM_NO_BLOCK;
+        }
+        // a stale next (block taken meanwhile) is caught by the tag
+        uint32_t next = RPVC_ATOMIC_LOAD(&seg->blocks[index].next);
+        uint32_t newTop = ((top + SB_SHM_TAG_STEP) & ~SB_SHM_NO_BLOCK) | next;
+        if (RPVC_ATOMIC_CAS(&seg->freeTop, top, newTop)) {
+            return index;
+        }
+    }
+}
+
+static void pushFreeBlock(SbShmSegment_t *seg, uint32_t index)
+{
+    while (true) {
+        uint32_t top = RPVC_ATOMIC_LOAD(&seg->freeTop);
+        RPVC_ATOMIC_STORE(&seg->blocks[index].next, top & SB_SHM_NO_BLOCK);
+        uint32_t newTop = ((top + SB_SHM_TAG_STEP) & ~SB_SHM_NO_BLOCK) | index;
+        if (RPVC_ATOMIC_CAS(&seg->freeTop, top, newTop)) {
+            return;
+        }
+    }
+}
+
+static void dropBlockReference(SbShmSegment_t *seg, uint32_t index, uint32_t count)
+{
+    if (RPVC_ATOMIC_FETCH_SUB(&seg->blocks[index].refCount, count) == count) {
+        pushFreeBlock(seg, index);
+    }
+}
+
+static bool enqueueBlock(SbShmPipe_t *pipe, uint32_t block)
+{
+    uint32_t pos = RPVC_ATOMIC_LOAD(&pipe->enqueuePos);
+    while (true) {
+        SbShmCell_t *cell = &pipe->cells[pos & (RPVC_SB_SHM_PIPE_DEPTH - 1)];
+        int32_t diff = (int32_t)(RPVC_ATOMIC_LOAD(&cell->sequence) - pos);
+        if (diff == 0) {
+            if (RPVC_ATOMIC_CAS(&pipe->enqueuePos, pos, pos + 1)) {
+                cell->block = block;
+                RPVC_ATOMIC_STORE(&cell->sequence, pos + 1);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false; // full
+        }
+        pos = RPVC_ATOMIC_LOAD(&pipe->enqueuePos);
+    }
+}
+
+static uint32_t dequeueBlock(SbShmPipe_t *pipe)
+{
+    uint32_t pos = pipe->dequeuePos;
+    SbShmCell_t *cell = &pipe->cells[pos & (RPVC_SB_SHM_PIPE_DEPTH - 1)];
+    if ((int32_t)(RPVC_ATOMIC_LOAD(&cell->sequence) - (pos + 1)) < 0) {
+        return SB_SHM_NO_BLOCK; // empty, or the next publisher has not finished writing
+    }
+
+    uint32_t block = cell->block;
+    RPVC_ATOMIC_STORE(&cell->sequence, pos + RPVC_SB_SHM_PIPE_DEPTH);
+    pipe->dequeuePos = pos + 1;
+    return block;
+}
+
+static void wakeReceiver(SbShmPipe_t *pipe)
+{
+    // pairs with the fence after waiters++ in RPVC_SB_ShmReceive
+    RPVC_ATOMIC_FENCE();
+    if (RPVC_ATOMIC_LOAD(&pipe->waiters) != 0) {
+        RPVC_ATOMIC_FETCH_ADD(&pipe->wakeSeq, 1);
+#if SB_SHM_USE_FUTEX
+        futexWake(&pipe->wakeSeq);
+#endif
+    }
+}
+
+static void initSegment(SbShmSegment_t *seg)
+{
+    memset(seg, 0, sizeof(*seg));
+    seg->version = SB_SHM_LAYOUT_VERSION;
+    seg->size = (uint32_t)sizeof(*seg);
+
+    for (uint32_t p = 0; p < RPVC_SB_MAX_PIPES; p++) {
+        for (uint32_t i = 0; i < RPVC_SB_SHM_PIPE_DEPTH; i++) {
+            seg->pipes[p].cells[i].sequence = i;
+        }
+    }
+
+    for (uint32_t i = 0; i < RPVC_SB_SHM_BLOCKS; i++) {
+        seg->blocks[i].next = (i + 1 < RPVC_SB_SHM_BLOCKS) ? i + 1 : SB_SHM_NO_BLOCK;
+    }
+    seg->freeTop = 0;
+
+    RPVC_ATOMIC_STORE(&seg->magic, SB_SHM_MAGIC);
+}
+
+RPVC_Status_t RPVC_SB_ShmCreate(const char *name, RPVC_SbShm_t *outBus)
+{
+    if (name == NULL || outBus == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return (errno == EEXIST) ? RPVC_ERR_STATE : RPVC_ERR_NO_RESOURCE;
+    }
+
+    if (ftruncate(fd, (off_t)sizeof(SbShmSegment_t)) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return RPVC_ERR_NO_RESOURCE;
+    }
+
+    void *mapping = mmap(NULL, sizeof(SbShmSegment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        shm_unlink(name);
+        return RPVC_ERR_NO_RESOURCE;
+    }
+
+    initSegment((SbShmSegment_t *)mapping);
+    outBus->segment = mapping;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_ShmAttach(const char *name, RPVC_SbShm_t *outBus)
+{
+    if (name == NULL || outBus == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    int fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0) {
+        return (errno == ENOENT) ? RPVC_ERR_NOT_FOUND : RPVC_ERR_NO_RESOURCE;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size != sizeof(SbShmSegment_t)) {
+        close(fd);
+        return RPVC_ERR_INTEGRITY;
+    }
+
+    void *mapping = mmap(NULL, sizeof(SbShmSegment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return RPVC_ERR_NO_RESOURCE;
+    }
+
+    SbShmSegment_t *seg = (SbShmSegment_t *)mapping;
+    if (RPVC_ATOMIC_LOAD(&seg->magic) != SB_SHM_MAGIC || seg->version != SB_SHM_LAYOUT_VERSION ||
+        seg->size != sizeof(SbShmSegment_t)) {
+        munmap(mapping, sizeof(SbShmSegment_t));
+        return RPVC_ERR_INTEGRITY;
+    }
+
+    outBus->segment = mapping;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_ShmDetach(RPVC_SbShm_t *bus)
+{
+    SbShmSegment_t *seg = segmentOf(bus);
+    if (seg == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    munmap(seg, sizeof(SbShmSegment_t));
+    bus->segment = NULL;
+    return RPVC_OK;
+}
+
+RPVC_Status_t RPVC_SB_ShmDestroy(const char *name)
+{
+    if (name == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+    return (shm_unlink(name) == 0) ? RPVC_OK : RPVC_ERR_NOT_FOUND;
+}
+
+static RPVC_Status_t updateRoute(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId, bool subscribe)
+{
+    SbShmSegment_t *seg = segmentOf(bus);
+    if (seg == NULL) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (subscriberId >= RPVC_SB_MAX_PIPES || messageId >= RPVC_SB_MAX_MESSAGE_ID) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    uint32_t pipeBit = 1U << subscriberId;
+    while (true) {
+        uint32_t mask = RPVC_ATOMIC_LOAD(&seg->routes[messageId]);
+        if (!subscribe && (mask & pipeBit) == 0) {
+            return RPVC_ERR_NOT_FOUND;
+        }
+        uint32_t newMask = subscribe ? (mask | pipeBit) : (mask & ~pipeBit);
+        if (newMask == mask || RPVC_ATOMIC_CAS(&seg->routes[messageId], mask, newMask)) {
+            return RPVC_OK;
+        }
+    }
+}
+
+RPVC_Status_t RPVC_SB_ShmSubscribe(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId)
+{
+    return updateRoute(bus, subscriberId, messageId, true);
+}
+
+RPVC_Status_t RPVC_SB_ShmUnsubscribe(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, RPVC_SbMsgId_t messageId)
+{
+    return updateRoute(bus, subscriberId, messageId, false);
+}
+
+RPVC_Status_t RPVC_SB_ShmPublish(RPVC_SbShm_t *bus, RPVC_SbMsgId_t messageId, const uint8_t *data, size_t size)
+{
+    SbShmSegment_t *seg = segmentOf(bus);
+    if (seg == NULL) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (messageId >= RPVC_SB_MAX_MESSAGE_ID || (data == NULL && size > 0) || size > RPVC_SB_MAX_PAYLOAD_SIZE) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    uint32_t pipeMask = RPVC_ATOMIC_LOAD(&seg->routes[messageId]);
+    if (pipeMask == 0) {
+        return RPVC_ERR_OUT_OF_RANGE;
+    }
+
+    uint32_t index = popFreeBlock(seg);
+    if (index == SB_SHM_NO_BLOCK) {
+        return RPVC_ERR_NO_MEMORY;
+    }
+
+    SbShmBlock_t *block = &seg->blocks[index];
+    block->messageId = messageId;
+    block->len = (uint16_t)size;
+    if (size > 0) {
+        memcpy(block->payload, data, size);
+    }
+
+    // references for every pipe up front, so an early receiver cannot free the block
+    uint32_t targets = 0;
+    for (uint32_t pending = pipeMask; pending != 0; pending &= pending - 1) {
+        targets++;
+    }
+    RPVC_ATOMIC_STORE(&block->refCount, targets + 1);
+
+    uint32_t rejected = 0;
+    while (pipeMask != 0) {
+        uint32_t subscriberId = RPVC_CTZ32(pipeMask);
+        pipeMask &= pipeMask - 1;
+
+        SbShmPipe_t *pipe = &seg->pipes[subscriberId];
+        if (enqueueBlock(pipe, index)) {
+            wakeReceiver(pipe);
+        }
+        else {
+            RPVC_ATOMIC_FETCH_ADD(&pipe->dropCount, 1);
+            rejected++;
+        }
+    }
+
+    dropBlockReference(seg, index, rejected + 1);
+    return (rejected < targets) ? RPVC_OK : RPVC_ERR_OUT_OF_RANGE;
+}
+
+static bool copyOut(SbShmSegment_t *seg, SbShmPipe_t *pipe, uint8_t *outBuffer, size_t bufferSize, size_t *outSize)
+{
+    uint32_t index = dequeueBlock(pipe);
+    if (index == SB_SHM_NO_BLOCK) {
+        return false;
+    }
+
+    const SbShmBlock_t *block = &seg->blocks[index];
+    size_t copySize = block->len < bufferSize ? block->len : bufferSize;
+    memcpy(outBuffer, block->payload, copySize);
+    if (outSize != NULL) {
+        *outSize = block->len;
+    }
+    dropBlockReference(seg, index, 1);
+    return true;
+}
+
+static uint64_t monotonicMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000U + (uint64_t)now.tv_nsec / 1000000U;
+}
+
+RPVC_Status_t RPVC_SB_ShmReceive(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, uint8_t *outBuffer, size_t bufferSize, size_t *outSize, uint32_t timeoutMs)
+{
+    SbShmSegment_t *seg = segmentOf(bus);
+    if (seg == NULL) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (subscriberId >= RPVC_SB_MAX_PIPES || outBuffer == NULL || bufferSize == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    SbShmPipe_t *pipe = &seg->pipes[subscriberId];
+    if (copyOut(seg, pipe, outBuffer, bufferSize, outSize)) {
+        return RPVC_OK;
+    }
+    if (timeoutMs == 0) {
+        return RPVC_ERR_TIMEOUT;
+    }
+
+    uint64_t deadlineMs = monotonicMs() + timeoutMs;
+    while (true) {
+        RPVC_ATOMIC_FETCH_ADD(&pipe->waiters, 1);
+        RPVC_ATOMIC_FENCE();
+        uint32_t seen = RPVC_ATOMIC_LOAD(&pipe->wakeSeq);
+
+        // a publish after this check bumps wakeSeq, so the wait returns at once
+        if (copyOut(seg, pipe, outBuffer, bufferSize, outSize)) {
+            RPVC_ATOMIC_FETCH_SUB(&pipe->waiters, 1);
+            return RPVC_OK;
+        }
+
+        uint64_t remainingMs = 0;
+        if (timeoutMs != RPVC_SB_WAIT_FOREVER) {
+            uint64_t nowMs = monotonicMs();
+            if (nowMs >= deadlineMs) {
+                RPVC_ATOMIC_FETCH_SUB(&pipe->waiters, 1);
+                return RPVC_ERR_TIMEOUT;
+            }
+            remainingMs = deadlineMs - nowMs;
+        }
+
+#if SB_SHM_USE_FUTEX
+        struct timespec rel;
+        rel.tv_sec = (time_t)(remainingMs / 1000U);
+        rel.tv_nsec = (long)(remainingMs % 1000U) * 1000000L;
+        futexWait(&pipe->wakeSeq, seen, (timeoutMs == RPVC_SB_WAIT_FOREVER) ? NULL : &rel);
+#else
+        // no cross-process wait primitive: poll until wakeSeq moves
+        (void)remainingMs;
+        while (RPVC_ATOMIC_LOAD(&pipe->wakeSeq) == seen &&
+               (timeoutMs == RPVC_SB_WAIT_FOREVER || monotonicMs() < deadlineMs)) {
+            sched_yield();
+        }
+#endif
+        RPVC_ATOMIC_FETCH_SUB(&pipe->waiters, 1);
+    }
+}
+
+RPVC_Status_t RPVC_SB_ShmGetPipeDropCount(RPVC_SbShm_t *bus, RPVC_SbSubscriberId_t subscriberId, uint32_t *outDropCount)
+{
+    SbShmSegment_t *seg = segmentOf(bus);
+    if (seg == NULL) {
+        return RPVC_ERR_NOT_READY;
+    }
+
+    if (subscriberId >= RPVC_SB_MAX_PIPES || outDropCount == NULL) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+
+    *outDropCount = RPVC_ATOMIC_LOAD(&seg->pipes[subscriberId].dropCount);
+    return RPVC_OK;
+}
@@ -11,7 +11,7 @@ set(RPVC_ARCH "x86" CACHE STRING "Target architecture")
 # OS selection
 # ---------------------------------------------------------
 set(RPVC_OS "baremetal" CACHE STRING "Target OS")
-# Options: freertos, baremetal
+# Options: freertos, baremetal, posix
 
 # ---------------------------------------------------------
 # Feature flags
@@ -40,6 +40,17 @@ if(RPVC_OS STREQUAL "freertos")
     add_definitions(-DRPVC_OS_FREERTOS)
 elseif(RPVC_OS STREQUAL "baremetal")
     add_definitions(-DRPVC_OS_BAREMETAL)
+elseif(RPVC_OS STREQUAL "posix")
+    add_definitions(-DRPVC_OS_POSIX)
+endif()
+
+# ---------------------------------------------------------
+# Feature definitions
+# ---------------------------------------------------------
+if(RPVC_ENABLE_ATOMICS)
+    add_definitions(-DRPVC_ENABLE_ATOMICS=1)
+else()
+    add_definitions(-DRPVC_ENABLE_ATOMICS=0)
 endif()
 
 # ---------------------------------------------------------
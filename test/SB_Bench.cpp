@@ -0,0 +1,295 @@
+#include "repvicore.h"
+#include "RPVC_MEMORYPOOL.h"
+#include "SoftwareBus.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#ifdef RPVC_OS_POSIX
+#include <atomic>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#endif
+
+using namespace std;
+
+// Publish/receive throughput and publish-to-receive latency of the Software
+// Bus, written as JSON so runs can be compared between commits:
+//   repvicore_sb_bench [--messages N] [--out results.json]
+
+static const RPVC_SbMsgId_t BENCH_MSG_ID = 1;
+static const uint32_t PIPE_DEPTH = 32; // keeps every message in flight inside the slab
+static const uint32_t WARMUP_MESSAGES = 1000;
+static const int SUBSCRIBER_COUNTS[] = {1, 4, 10};
+static const size_t PAYLOAD_SIZES[] = {8, 64, 100};
+
+#define failOnError(status) \
+    do { \
+        if ((status) != RPVC_OK) { \
+            cerr << "Error: " << (int)(status) << " at " << __FILE__ << ":" << __LINE__ << endl; \
+            abort(); \
+        } \
+    } while (0)
+
+struct CaseResult {
+    const char *mode;
+    int subscribers;
+    size_t payloadSize;
+    uint32_t published;
+    uint64_t received;
+    uint32_t dropped;
+    double seconds;
+    bool pinned;
+    vector<uint32_t> latencyNs;
+};
+
+static RPVC_SbMsgHandle_t g_storage[RPVC_SB_MAX_PIPES][PIPE_DEPTH];
+
+static uint64_t nowNs()
+{
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The first 8 payload bytes carry the publish time
+static void publishStamped(uint8_t *payload, size_t size)
+{
+    uint64_t stamp = nowNs();
+    memcpy(payload, &stamp, sizeof(stamp));
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(BENCH_MSG_ID, payload, size, &mh));
+    failOnError(RPVC_SB_Publish(mh));
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+}
+
+static bool receiveStamped(RPVC_SbSubscriberId_t pipe, uint8_t *buffer, vector<uint32_t> &latencyNs)
+{
+    if (RPVC_SB_Receive(pipe, buffer, RPVC_SB_MAX_PAYLOAD_SIZE) != RPVC_OK) {
+        return false;
+    }
+    uint64_t stamp;
+    memcpy(&stamp, buffer, sizeof(stamp));
+    latencyNs.push_back((uint32_t)min<uint64_t>(nowNs() - stamp, UINT32_MAX));
+    return true;
+}
+
+static uint32_t droppedSoFar(int subscribers)
+{
+    uint32_t dropped = 0;
+    for (int s = 0; s < subscribers; s++) {
+        uint32_t pipeDrops = 0;
+        failOnError(RPVC_SB_GetPipeDropCount((RPVC_SbSubscriberId_t)s, &pipeDrops));
+        dropped += pipeDrops;
+    }
+    return dropped;
+}
+
+// One thread publishes a message and takes it from every pipe before the next
+static void runSingleThread(CaseResult &result, uint32_t messages)
+{
+    uint8_t payload[RPVC_SB_MAX_PAYLOAD_SIZE] = {0};
+    uint8_t buffer[RPVC_SB_MAX_PAYLOAD_SIZE];
+    result.latencyNs.reserve((size_t)messages * result.subscribers);
+
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < messages; i++) {
+        publishStamped(payload, result.payloadSize);
+        for (int s = 0; s < result.subscribers; s++) {
+            if (receiveStamped((RPVC_SbSubscriberId_t)s, buffer, result.latencyNs)) {
+                result.received++;
+            }
+        }
+    }
+    result.seconds = (double)(nowNs() - start) / 1e9;
+    result.published = messages;
+}
+
+#ifdef RPVC_OS_POSIX
+static bool pinToCore(unsigned core)
+{
+#ifdef __linux__
+    if (thread::hardware_concurrency() < 2) {
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+// A producer paced by the topic's credit, so nothing is dropped, and a
+// consumer polling every pipe, each on its own core where the host allows
+static void runProducerConsumer(CaseResult &result, uint32_t messages)
+{
+    atomic<bool> consumerReady(false);
+    atomic<bool> consumerPinned(false);
+    result.latencyNs.reserve((size_t)messages * result.subscribers);
+    uint64_t expected = (uint64_t)messages * result.subscribers;
+
+    thread consumer([&]() {
+        consumerPinned = pinToCore(1);
+        consumerReady = true;
+        uint8_t buffer[RPVC_SB_MAX_PAYLOAD_SIZE];
+        while (result.received < expected) {
+            bool idle = true;
+            for (int s = 0; s < result.subscribers; s++) {
+                while (receiveStamped((RPVC_SbSubscriberId_t)s, buffer, result.latencyNs)) {
+                    result.received++;
+                    idle = false;
+                }
+            }
+            if (idle) {
+                this_thread::yield();
+            }
+        }
+    });
+
+    bool producerPinned = pinToCore(0);
+    while (!consumerReady) {
+        this_thread::yield();
+    }
+
+    uint8_t payload[RPVC_SB_MAX_PAYLOAD_SIZE] = {0};
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < messages; i++) {
+        uint32_t credit = 0;
+        failOnError(RPVC_SB_GetCredit(BENCH_MSG_ID, &credit));
+        while (credit == 0) {
+            this_thread::yield();
+            failOnError(RPVC_SB_GetCredit(BENCH_MSG_ID, &credit));
+        }
+        publishStamped(payload, result.payloadSize);
+    }
+    consumer.join();
+    result.seconds = (double)(nowNs() - start) / 1e9;
+    result.published = messages;
+    result.pinned = producerPinned && consumerPinned;
+}
+#endif
+
+static CaseResult runCase(const char *mode, int subscribers, size_t payloadSize, uint32_t messages)
+{
+    CaseResult result = {mode, subscribers, payloadSize, 0, 0, 0, 0.0, false, {}};
+    uint32_t droppedBefore = droppedSoFar(subscribers);
+    for (int s = 0; s < subscribers; s++) {
+        failOnError(RPVC_SB_Subscribe((RPVC_SbSubscriberId_t)s, BENCH_MSG_ID));
+    }
+    if (strcmp(mode, "single_thread") == 0) {
+        runSingleThread(result, messages);
+    }
+#ifdef RPVC_OS_POSIX
+    else {
+        runProducerConsumer(result, messages);
+    }
+#endif
+    result.dropped = droppedSoFar(subscribers) - droppedBefore;
+    for (int s = 0; s < subscribers; s++) {
+        failOnError(RPVC_SB_Unsubscribe((RPVC_SbSubscriberId_t)s, BENCH_MSG_ID));
+        failOnError(RPVC_SB_Flush((RPVC_SbSubscriberId_t)s));
+    }
+    return result;
+}
+
+static uint32_t percentile(const vector<uint32_t> &sorted, double fraction)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = (size_t)(fraction * (double)(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static void writeResult(FILE *out, CaseResult &result, bool last)
+{
+    sort(result.latencyNs.begin(), result.latencyNs.end());
+    const vector<uint32_t> &latency = result.latencyNs;
+    double seconds = result.seconds > 0.0 ? result.seconds : 1e-9;
+    fprintf(out,
+            "    {\"mode\": \"%s\", \"subscribers\": %d, \"payload_bytes\": %zu, \"pinned\": %s,\n"
+            "     \"published\": %u, \"received\": %llu, \"dropped\": %u, \"seconds\": %.6f,\n"
+            "     \"publish_rate\": %.0f, \"delivery_rate\": %.0f,\n"
+            "     \"latency_ns\": {\"min\": %u, \"p50\": %u, \"p90\": %u, \"p99\": %u, \"p999\": %u, \"max\": %u}}%s\n",
+            result.mode, result.subscribers, result.payloadSize, result.pinned ? "true" : "false",
+            result.published, (unsigned long long)result.received, result.dropped, result.seconds,
+            result.published / seconds, (double)result.received / seconds,
+            percentile(latency, 0.0), percentile(latency, 0.5), percentile(latency, 0.9),
+            percentile(latency, 0.99), percentile(latency, 0.999), percentile(latency, 1.0),
+            last ? "" : ",");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t messages = 100000;
+    const char *outPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--messages") == 0 && i + 1 < argc) {
+            messages = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else {
+            cerr << "usage: " << argv[0] << " [--messages N] [--out results.json]" << endl;
+            return 2;
+        }
+    }
+    if (messages == 0) {
+        cerr << "--messages must be at least 1" << endl;
+        return 2;
+    }
+
+    const RPVC_SoftwareBusConfig_t sbConfig = {};
+    failOnError(RPVC_MEMORYPOOL_Init());
+    failOnError(RPVC_SB_Init(&sbConfig));
+    for (int s = 0; s < RPVC_SB_MAX_PIPES; s++) {
+        const RPVC_SbPipeConfig_t config = {PIPE_DEPTH, RPVC_SB_OVERFLOW_DROP_NEWEST, g_storage[s]};
+        failOnError(RPVC_SB_CreatePipe((RPVC_SbSubscriberId_t)s, &config));
+    }
+
+    vector<const char*> modes = {"single_thread"};
+#ifdef RPVC_OS_POSIX
+    modes.push_back("producer_consumer");
+#endif
+    vector<CaseResult> results;
+    for (const char *mode : modes) {
+        for (int subscribers : SUBSCRIBER_COUNTS) {
+            for (size_t payloadSize : PAYLOAD_SIZES) {
+                runCase(mode, subscribers, payloadSize, WARMUP_MESSAGES);
+                results.push_back(runCase(mode, subscribers, payloadSize, messages));
+            }
+        }
+    }
+
+    FILE *out = outPath != nullptr ? fopen(outPath, "w") : stdout;
+    if (out == nullptr) {
+        cerr << "Cannot open " << outPath << endl;
+        return 1;
+    }
+#ifdef RPVC_OS_POSIX
+    const char *os = "posix";
+#else
+    const char *os = "baremetal";
+#endif
+    fprintf(out, "{\n  \"benchmark\": \"software_bus\",\n  \"os\": \"%s\",\n  \"messages_per_case\": %u,\n  \"pipe_depth\": %u,\n  \"results\": [\n",
+            os, messages, PIPE_DEPTH);
+    for (size_t i = 0; i < results.size(); i++) {
+        writeResult(out, results[i], i + 1 == results.size());
+    }
+    fprintf(out, "  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    failOnError(RPVC_SB_Deinit());
+    failOnError(RPVC_MEMORYPOOL_Deinit());
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include <iostream>
+using namespace std;
+
+#ifdef RPVC_OS_POSIX
+#include "RPVC_MEMORYPOOL.h"
+#include "SoftwareBusBridge.h"
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <arpa/inet.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Node A publishes message 1; node B echoes each one back as message 2.
+// Both bridges forward both IDs, so anything echoed in a loop shows up as
+// extra copies on node A.
+static const uint32_t MESSAGE_COUNT = 2000;
+static const uint32_t WINDOW = 32; // keeps every pipe below its depth
+static const RPVC_SbMsgId_t FORWARDED[] = {1, 2};
+static const RPVC_SbSubscriberId_t BRIDGE_PIPE = 9;
+
+#define failOnError(status) \
+    do { \
+        if ((status) != RPVC_OK) { \
+            cout << "Error: " << (int)(status) << " at " << __FILE__ << ":" << __LINE__ << endl; \
+            abort(); \
+        } \
+    } while (0)
+
+static RPVC_SbBridge_t g_bridge;
+
+static void startNode(RPVC_SbBridgeTransport_t transport, const string &local, const string &peer)
+{
+    const RPVC_SoftwareBusConfig_t sbConfig = {};
+    failOnError(RPVC_MEMORYPOOL_Init());
+    failOnError(RPVC_SB_Init(&sbConfig));
+
+    const RPVC_SbPipeConfig_t deep = {64, RPVC_SB_OVERFLOW_DROP_NEWEST, nullptr};
+    failOnError(RPVC_SB_CreatePipe(BRIDGE_PIPE, &deep));
+    failOnError(RPVC_SB_CreatePipe(0, &deep));
+    failOnError(RPVC_SB_CreatePipe(1, &deep));
+
+    RPVC_SbBridgeConfig_t config = {};
+    config.transport = transport;
+    config.localAddress = local.c_str();
+    config.peerAddress = peer.c_str();
+    config.messageIds = FORWARDED;
+    config.messageIdCount = 2;
+    config.pipeId = BRIDGE_PIPE;
+    config.flushDeadlineUs = 200;
+    failOnError(RPVC_SB_BridgeOpen(&g_bridge, &config));
+}
+
+static void publishValue(RPVC_SbMsgId_t messageId, uint32_t value)
+{
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(messageId, (const uint8_t*)&value, sizeof(value), &mh));
+    failOnError(RPVC_SB_Publish(mh));
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+}
+
+static bool timedOut(chrono::steady_clock::time_point start)
+{
+    return chrono::steady_clock::now() - start > chrono::seconds(10);
+}
+
+static int runEchoNode(RPVC_SbBridgeTransport_t transport, const string &local, const string &peer, int readyFd)
+{
+    startNode(transport, local, peer);
+    failOnError(RPVC_SB_Subscribe(0, 1));
+
+    // datagrams sent before the peer socket is bound are lost
+    const char ready = 1;
+    assert(write(readyFd, &ready, 1) == 1);
+    close(readyFd);
+
+    uint32_t echoed = 0;
+    auto start = chrono::steady_clock::now();
+    while (echoed < MESSAGE_COUNT && !timedOut(start)) {
+        failOnError(RPVC_SB_BridgePoll(&g_bridge));
+        uint32_t value = 0;
+        while (RPVC_SB_Receive(0, (uint8_t*)&value, sizeof(value)) == RPVC_OK) {
+            publishValue(2, value);
+            echoed++;
+        }
+    }
+    failOnError(RPVC_SB_BridgeClose(&g_bridge));
+    return echoed == MESSAGE_COUNT ? 0 : 1;
+}
+
+static void runTransport(RPVC_SbBridgeTransport_t transport, const string &localA, const string &localB)
+{
+    int readyPipe[2];
+    assert(pipe(readyPipe) == 0);
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        close(readyPipe[0]);
+        _exit(runEchoNode(transport, localB, localA, readyPipe[1]));
+    }
+
+    close(readyPipe[1]);
+    startNode(transport, localA, localB);
+    char ready = 0;
+    assert(read(readyPipe[0], &ready, 1) == 1);
+    close(readyPipe[0]);
+    failOnError(RPVC_SB_Subscribe(0, 2)); // echoes
+    failOnError(RPVC_SB_Subscribe(1, 1)); // local copies of our own messages
+
+    uint32_t sent = 0, echoes = 0, localCopies = 0;
+    uint64_t echoSum = 0;
+    auto start = chrono::steady_clock::now();
+    while (echoes < MESSAGE_COUNT && !timedOut(start)) {
+        while (sent < MESSAGE_COUNT && sent - echoes < WINDOW) {
+            publishValue(1, sent++);
+        }
+        failOnError(RPVC_SB_BridgePoll(&g_bridge));
+
+        uint32_t value = 0;
+        while (RPVC_SB_Receive(0, (uint8_t*)&value, sizeof(value)) == RPVC_OK) {
+            echoSum += value;
+            echoes++;
+        }
+        while (RPVC_SB_Receive(1, (uint8_t*)&value, sizeof(value)) == RPVC_OK) {
+            localCopies++;
+        }
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(echoes == MESSAGE_COUNT);
+    assert(echoSum == (uint64_t)MESSAGE_COUNT * (MESSAGE_COUNT - 1) / 2);
+    assert(localCopies == MESSAGE_COUNT); // nothing came back around the loop
+
+    RPVC_SbBridgeStats_t stats;
+    failOnError(RPVC_SB_BridgeGetStats(&g_bridge, &stats));
+    assert(stats.messagesSent == MESSAGE_COUNT && stats.messagesReceived == MESSAGE_COUNT);
+    assert(stats.datagramsSent < stats.messagesSent); // coalescing happened
+
+    failOnError(RPVC_SB_BridgeClose(&g_bridge));
+    failOnError(RPVC_SB_Deinit());
+    failOnError(RPVC_MEMORYPOOL_Deinit());
+}
+
+// Only the configured peer may publish, and a failed open subscribes nothing
+static void testIsolation(int port)
+{
+    startNode(RPVC_SB_BRIDGE_UDP, "127.0.0.1:" + to_string(port), "127.0.0.1:" + to_string(port + 1));
+    failOnError(RPVC_SB_Subscribe(0, 1));
+
+    int intruder = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(intruder >= 0);
+    struct sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_port = htons((uint16_t)port);
+    target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const uint8_t datagram[16] = {0};
+    assert(sendto(intruder, datagram, sizeof(datagram), 0, (const struct sockaddr*)&target, sizeof(target)) ==
+           (ssize_t)sizeof(datagram));
+    close(intruder);
+
+    // the connected socket never even sees it
+    auto start = chrono::steady_clock::now();
+    while (chrono::steady_clock::now() - start < chrono::milliseconds(100)) {
+        failOnError(RPVC_SB_BridgePoll(&g_bridge));
+    }
+    RPVC_SbBridgeStats_t stats;
+    failOnError(RPVC_SB_BridgeGetStats(&g_bridge, &stats));
+    assert(stats.malformedDatagrams == 0 && stats.messagesReceived == 0);
+    uint32_t value = 0;
+    assert(RPVC_SB_Receive(0, (uint8_t*)&value, sizeof(value)) != RPVC_OK);
+    failOnError(RPVC_SB_BridgeClose(&g_bridge));
+
+    const RPVC_SbMsgId_t badIds[] = {3, RPVC_SB_MAX_MESSAGE_ID};
+    RPVC_SbBridgeConfig_t config = {};
+    config.transport = RPVC_SB_BRIDGE_UDP;
+    string local = "127.0.0.1:" + to_string(port), peer = "127.0.0.1:" + to_string(port + 1);
+    config.localAddress = local.c_str();
+    config.peerAddress = peer.c_str();
+    config.messageIds = badIds;
+    config.messageIdCount = 2;
+    config.pipeId = BRIDGE_PIPE;
+    RPVC_SbBridge_t failed;
+    assert(RPVC_SB_BridgeOpen(&failed, &config) != RPVC_OK);
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(3, (const uint8_t*)&value, sizeof(value), &mh));
+    assert(RPVC_SB_Publish(mh) == RPVC_ERR_OUT_OF_RANGE); // no subscriber left behind
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+
+    failOnError(RPVC_SB_Deinit());
+    failOnError(RPVC_MEMORYPOOL_Deinit());
+}
+
+int main()
+{
+    int base = 20000 + (int)(getpid() % 20000) * 2;
+    runTransport(RPVC_SB_BRIDGE_UDP,
+                 "127.0.0.1:" + to_string(base), "127.0.0.1:" + to_string(base + 1));
+    cout << "UDP bridge test completed." << endl;
+
+    string dir = "/tmp/rpvc_sb_bridge_" + to_string(getpid());
+    runTransport(RPVC_SB_BRIDGE_UNIX, dir + "_a.sock", dir + "_b.sock");
+    cout << "Unix bridge test completed." << endl;
+
+    testIsolation(base + 2);
+    cout << "Bridge isolation test completed." << endl;
+    return 0;
+}
+
+#else
+
+int main()
+{
+    cout << "Software Bus bridge needs RPVC_OS=posix; skipped." << endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,165 @@
+#include <iostream>
+using namespace std;
+
+#ifdef RPVC_OS_POSIX
+#include "RPVC_MEMORYPOOL.h"
+#include "SoftwareBusLog.h"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+static const uint32_t MESSAGE_COUNT = 1000;
+static const uint32_t SEEK_AT = 500;
+static const RPVC_SbMsgId_t RECORDED[] = {1};
+static const RPVC_SbSubscriberId_t RECORDER_PIPE = 9;
+
+#define failOnError(status) \
+    do { \
+        if ((status) != RPVC_OK) { \
+            cout << "Error: " << (int)(status) << " at " << __FILE__ << ":" << __LINE__ << endl; \
+            abort(); \
+        } \
+    } while (0)
+
+static RPVC_SbRecorder_t g_recorder;
+static RPVC_SbPlayer_t g_player;
+
+static uint64_t wallClockUs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+static void publishValue(uint32_t value)
+{
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(1, (const uint8_t*)&value, sizeof(value), &mh));
+    failOnError(RPVC_SB_Publish(mh));
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+}
+
+// Records MESSAGE_COUNT values; returns a time that falls just before value SEEK_AT
+static uint64_t recordLog(const string &basePath)
+{
+    RPVC_SbRecorderConfig_t config = {};
+    config.basePath = basePath.c_str();
+    config.messageIds = RECORDED;
+    config.messageIdCount = 1;
+    config.pipeId = RECORDER_PIPE;
+    config.segmentSize = 4096; // forces several segments
+    failOnError(RPVC_SB_RecorderOpen(&g_recorder, &config));
+
+    uint64_t seekUs = 0;
+    for (uint32_t i = 0; i < MESSAGE_COUNT; i++) {
+        if (i == SEEK_AT) {
+            failOnError(RPVC_SB_RecorderPoll(&g_recorder));
+            this_thread::sleep_for(chrono::milliseconds(2));
+            seekUs = wallClockUs();
+            this_thread::sleep_for(chrono::milliseconds(2));
+        }
+        publishValue(i);
+        if (i % 32 == 31) {
+            failOnError(RPVC_SB_RecorderPoll(&g_recorder));
+        }
+    }
+    failOnError(RPVC_SB_RecorderClose(&g_recorder));
+    assert(RPVC_SB_RecorderPoll(&g_recorder) == RPVC_ERR_NOT_READY);
+    return seekUs;
+}
+
+// Plays to the end and checks the values arrive in order from firstValue
+static uint32_t playAll(uint32_t firstValue)
+{
+    uint32_t expected = firstValue;
+    size_t published = 0;
+    RPVC_Status_t status;
+    while ((status = RPVC_SB_PlayerPoll(&g_player, 32, &published)) == RPVC_OK) {
+        uint32_t value = 0;
+        while (RPVC_SB_Receive(0, (uint8_t*)&value, sizeof(value)) == RPVC_OK) {
+            assert(value == expected);
+            expected++;
+        }
+        if (published == 0) {
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+    }
+    assert(status == RPVC_ERR_OUT_OF_RANGE);
+    return expected - firstValue;
+}
+
+int main()
+{
+    const RPVC_SoftwareBusConfig_t sbConfig = {};
+    failOnError(RPVC_MEMORYPOOL_Init());
+    failOnError(RPVC_SB_Init(&sbConfig));
+    const RPVC_SbPipeConfig_t deep = {64, RPVC_SB_OVERFLOW_DROP_NEWEST, nullptr};
+    failOnError(RPVC_SB_CreatePipe(RECORDER_PIPE, &deep));
+
+    string basePath = "/tmp/rpvc_sb_log_" + to_string(getpid());
+    uint64_t seekUs = recordLog(basePath);
+
+    failOnError(RPVC_SB_CreatePipe(0, &deep));
+    failOnError(RPVC_SB_Subscribe(0, 1));
+
+    failOnError(RPVC_SB_PlayerOpen(&g_player, basePath.c_str(), RPVC_SB_PLAY_FAST));
+    assert(playAll(0) == MESSAGE_COUNT);
+
+    failOnError(RPVC_SB_PlayerSeek(&g_player, seekUs));
+    assert(playAll(SEEK_AT) == MESSAGE_COUNT - SEEK_AT);
+    assert(RPVC_SB_PlayerSeek(&g_player, wallClockUs()) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_PlayerClose(&g_player));
+
+    // the recording holds two 2 ms pauses, so a paced replay cannot finish sooner
+    failOnError(RPVC_SB_PlayerOpen(&g_player, basePath.c_str(), RPVC_SB_PLAY_RECORDED_TIMING));
+    auto start = chrono::steady_clock::now();
+    assert(playAll(0) == MESSAGE_COUNT);
+    assert(chrono::steady_clock::now() - start >= chrono::milliseconds(3));
+    failOnError(RPVC_SB_PlayerClose(&g_player));
+
+    assert(RPVC_SB_PlayerOpen(&g_player, "/tmp/rpvc_sb_log_missing", RPVC_SB_PLAY_FAST) == RPVC_ERR_NOT_FOUND);
+
+    // a failed open leaves no subscription and no segment behind
+    const RPVC_SbMsgId_t partlyBad[] = {2, RPVC_SB_MAX_MESSAGE_ID};
+    string failedPath = basePath + "_failed";
+    RPVC_SbRecorderConfig_t failed = {};
+    failed.basePath = failedPath.c_str();
+    failed.messageIds = partlyBad;
+    failed.messageIdCount = 2;
+    failed.pipeId = RECORDER_PIPE;
+    assert(RPVC_SB_RecorderOpen(&g_recorder, &failed) == RPVC_ERR_INVALID_ARG);
+    assert(access((failedPath + ".0000").c_str(), F_OK) != 0);
+    uint8_t byte = 0;
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(2, &byte, 1, &mh));
+    assert(RPVC_SB_Publish(mh) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+
+    for (uint32_t segment = 0; segment < RPVC_SB_LOG_MAX_SEGMENTS; segment++) {
+        char path[300];
+        snprintf(path, sizeof(path), "%s.%04u", basePath.c_str(), (unsigned)segment);
+        if (remove(path) != 0) {
+            assert(segment > 1); // the log spans several segments
+            break;
+        }
+    }
+
+    failOnError(RPVC_SB_Deinit());
+    failOnError(RPVC_MEMORYPOOL_Deinit());
+    cout << "Record and replay test completed." << endl;
+    return 0;
+}
+
+#else
+
+int main()
+{
+    cout << "Software Bus record and replay needs RPVC_OS=posix; skipped." << endl;
+    return 0;
+}
+
+#endif
@@ -2,8 +2,18 @@
 #include "RPVC_MEMORYPOOL.h"
 #include "SoftwareBus.h"
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <vector>
+#ifdef RPVC_OS_POSIX
+#include <atomic>
+#include <thread>
+#include <chrono>
+#endif
+#if defined(RPVC_OS_POSIX) && defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
 
 #include <iostream>
 using namespace std;
@@ -36,6 +46,1306 @@ string getErrorName(RPVC_Status_t status)
         } \
     } while (0)
 
+static RPVC_SbMsgHandle_t publishText(RPVC_SbMsgId_t msgId, const char *text)
+{
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(msgId, (const uint8_t*)text, strlen(text) + 1, &mh));
+    failOnError(RPVC_SB_Publish(mh));
+    return mh;
+}
+
+// Pipe 0 on message 0: poll behaviour everywhere, real blocking on hosts with the POSIX OSAL.
+static void testReceiveTimeout()
+{
+    failOnError(RPVC_SB_Subscribe(0, 0));
+    uint8_t buf[RPVC_SB_MAX_PAYLOAD_SIZE] = {0};
+
+    assert(RPVC_SB_ReceiveTimeout(0, buf, sizeof(buf), 0) == RPVC_ERR_TIMEOUT);
+    RPVC_SbMsgHandle_t mh = publishText(0, "poll");
+    failOnError(RPVC_SB_ReceiveTimeout(0, buf, sizeof(buf), 0));
+    assert(strcmp((const char*)buf, "poll") == 0);
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+
+#ifdef RPVC_OS_POSIX
+    assert(RPVC_SB_ReceiveTimeout(0, buf, sizeof(buf), 10) == RPVC_ERR_TIMEOUT);
+
+    thread publisher([&mh]() {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        mh = publishText(0, "wake");
+    });
+    failOnError(RPVC_SB_ReceiveTimeout(0, buf, sizeof(buf), 1000));
+    assert(strcmp((const char*)buf, "wake") == 0);
+    publisher.join();
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+#endif
+
+    failOnError(RPVC_SB_Flush(0));
+    failOnError(RPVC_SB_Unsubscribe(0, 0));
+    cout << "ReceiveTimeout test completed." << endl;
+}
+
+// Pipes 1 and 2 share message 1, pipe 2 also gets message 2: order is kept per pipe.
+static void testBatch()
+{
+    failOnError(RPVC_SB_Subscribe(1, 1));
+    failOnError(RPVC_SB_Subscribe(2, 1));
+    failOnError(RPVC_SB_Subscribe(2, 2));
+
+    const RPVC_SbMsgId_t ids[4] = {1, 2, 1, 2};
+    RPVC_SbMsgHandle_t batch[4];
+    for (int i = 0; i < 4; ++i) {
+        uint8_t value = (uint8_t)i;
+        failOnError(RPVC_SB_CreateMessage(ids[i], &value, 1, &batch[i]));
+    }
+    failOnError(RPVC_SB_PublishBatch(batch, 4));
+    for (auto h : batch) {
+        failOnError(RPVC_SB_ReleaseMessage(h)); // pipes keep their own references
+    }
+
+    RPVC_SbMsgHandle_t got[8];
+    size_t count = 0;
+    failOnError(RPVC_SB_ReceiveBatch(1, got, 8, &count));
+    assert(count == 2);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        failOnError(RPVC_SB_GetMessagePayload(got[i], &data, &size));
+        assert(size == 1 && data[0] == (uint8_t)(i * 2));
+        failOnError(RPVC_SB_ReleaseMessage(got[i]));
+    }
+
+    failOnError(RPVC_SB_ReceiveBatch(2, got, 8, &count));
+    assert(count == 4);
+    for (size_t i = 0; i < count; ++i) {
+        RPVC_SbMsgId_t id = 0;
+        failOnError(RPVC_SB_GetMessageId(got[i], &id));
+        assert(id == ids[i]);
+        failOnError(RPVC_SB_ReleaseMessage(got[i]));
+    }
+    assert(RPVC_SB_ReceiveBatch(2, got, 8, &count) == RPVC_ERR_OUT_OF_RANGE && count == 0);
+
+    failOnError(RPVC_SB_Unsubscribe(1, 1));
+    failOnError(RPVC_SB_Unsubscribe(2, 1));
+    failOnError(RPVC_SB_Unsubscribe(2, 2));
+    cout << "Batch test completed." << endl;
+}
+
+static void testLoan()
+{
+    failOnError(RPVC_SB_Subscribe(3, 3));
+
+    RPVC_SbMsgHandle_t mh = nullptr;
+    uint8_t *writePtr = nullptr;
+    assert(RPVC_SB_LoanMessage(3, RPVC_SB_MAX_PAYLOAD_SIZE + 1, &mh, &writePtr) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_LoanMessage(3, 6, &mh, &writePtr));
+    memcpy(writePtr, "inpl!", 6);
+    failOnError(RPVC_SB_PublishLoaned(mh));
+
+    uint8_t buf[RPVC_SB_MAX_PAYLOAD_SIZE] = {0};
+    failOnError(RPVC_SB_Receive(3, buf, sizeof(buf)));
+    assert(strcmp((const char*)buf, "inpl!") == 0);
+
+    // only outstanding loans can be published through the loan path
+    mh = publishText(3, "copy");
+    assert(RPVC_SB_PublishLoaned(mh) == RPVC_ERR_STATE);
+    failOnError(RPVC_SB_Flush(3));
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+
+    failOnError(RPVC_SB_Unsubscribe(3, 3));
+    cout << "Loan test completed." << endl;
+}
+
+static void testVariableSize()
+{
+    failOnError(RPVC_SB_Subscribe(4, 4));
+
+    // the largest payload round-trips intact
+    RPVC_SbMsgHandle_t mh = nullptr;
+    uint8_t *writePtr = nullptr;
+    failOnError(RPVC_SB_LoanMessage(4, RPVC_SB_MAX_PAYLOAD_SIZE, &mh, &writePtr));
+    for (size_t i = 0; i < RPVC_SB_MAX_PAYLOAD_SIZE; ++i) {
+        writePtr[i] = (uint8_t)i;
+    }
+    failOnError(RPVC_SB_PublishLoaned(mh));
+    uint8_t buf[RPVC_SB_MAX_PAYLOAD_SIZE] = {0};
+    failOnError(RPVC_SB_Receive(4, buf, sizeof(buf)));
+    for (size_t i = 0; i < RPVC_SB_MAX_PAYLOAD_SIZE; ++i) {
+        assert(buf[i] == (uint8_t)i);
+    }
+
+    // small messages take small blocks, so far more of them fit than 128-byte blocks would allow
+    vector<RPVC_SbMsgHandle_t> handles;
+    const uint8_t heartbeat[8] = {0};
+    for (int i = 0; i < 300; ++i) {
+        RPVC_SbMsgHandle_t h = nullptr;
+        failOnError(RPVC_SB_CreateMessage(4, heartbeat, sizeof(heartbeat), &h));
+        handles.push_back(h);
+    }
+    for (auto h : handles) {
+        failOnError(RPVC_SB_ReleaseMessage(h));
+    }
+
+    failOnError(RPVC_SB_Unsubscribe(4, 4));
+    cout << "Variable size test completed." << endl;
+}
+
+static RPVC_Status_t publishByte(RPVC_SbMsgId_t msgId, uint8_t value)
+{
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(msgId, &value, 1, &mh));
+    RPVC_Status_t st = RPVC_SB_Publish(mh);
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+    return st;
+}
+
+static void testPipePolicies()
+{
+    static RPVC_SbMsgHandle_t commandSlots[2];
+    RPVC_SbPipeConfig_t telemetry = {8, RPVC_SB_OVERFLOW_DROP_OLDEST, nullptr};
+    RPVC_SbPipeConfig_t command = {2, RPVC_SB_OVERFLOW_REJECT, commandSlots};
+    RPVC_SbPipeConfig_t invalid = {0, RPVC_SB_OVERFLOW_REJECT, nullptr};
+    assert(RPVC_SB_CreatePipe(5, &invalid) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_CreatePipe(5, &telemetry));
+    failOnError(RPVC_SB_CreatePipe(6, &command));
+    failOnError(RPVC_SB_Subscribe(5, 5));
+    failOnError(RPVC_SB_Subscribe(6, 5));
+    assert(RPVC_SB_CreatePipe(5, &telemetry) == RPVC_ERR_STATE);
+
+    // a full reject pipe refuses the publish for every subscriber
+    failOnError(publishByte(5, 0));
+    failOnError(publishByte(5, 1));
+    assert(publishByte(5, 2) == RPVC_ERR_NO_RESOURCE);
+    uint32_t dropped = 0;
+    failOnError(RPVC_SB_GetPipeDropCount(6, &dropped));
+    assert(dropped == 1);
+    failOnError(RPVC_SB_Unsubscribe(6, 5));
+    failOnError(RPVC_SB_Flush(6));
+
+    // drop-oldest keeps the newest depth messages
+    for (uint8_t i = 2; i < 12; ++i) {
+        failOnError(publishByte(5, i));
+    }
+    failOnError(RPVC_SB_GetPipeDropCount(5, &dropped));
+    assert(dropped == 4);
+    uint8_t value = 0;
+    for (uint8_t expected = 4; expected < 12; ++expected) {
+        failOnError(RPVC_SB_Receive(5, &value, 1));
+        assert(value == expected);
+    }
+    assert(RPVC_SB_Receive(5, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+
+    // same through the batch path
+    RPVC_SbMsgHandle_t batch[10];
+    for (uint8_t i = 0; i < 10; ++i) {
+        failOnError(RPVC_SB_CreateMessage(5, &i, 1, &batch[i]));
+    }
+    failOnError(RPVC_SB_PublishBatch(batch, 10));
+    for (auto h : batch) {
+        failOnError(RPVC_SB_ReleaseMessage(h));
+    }
+    for (uint8_t expected = 2; expected < 10; ++expected) {
+        failOnError(RPVC_SB_Receive(5, &value, 1));
+        assert(value == expected);
+    }
+    failOnError(RPVC_SB_Unsubscribe(5, 5));
+    failOnError(RPVC_SB_Flush(5));
+
+    // unconfigured pipes keep the default depth and drop the newest
+    uint32_t droppedBefore = 0;
+    failOnError(RPVC_SB_GetPipeDropCount(7, &droppedBefore));
+    failOnError(RPVC_SB_Subscribe(7, 6));
+    for (uint8_t i = 0; i < RPVC_SB_MAX_QUEUE_DEPTH; ++i) {
+        failOnError(publishByte(6, i));
+    }
+    assert(publishByte(6, 0xFF) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_GetPipeDropCount(7, &dropped));
+    assert(dropped == droppedBefore + 1);
+    failOnError(RPVC_SB_Unsubscribe(7, 6));
+    failOnError(RPVC_SB_Flush(7));
+    cout << "Pipe policy test completed." << endl;
+}
+
+static void testSubscribeOptions()
+{
+    RPVC_SbSubscribeOptions_t everyFourth = {};
+    everyFourth.decimation = 4;
+    failOnError(RPVC_SB_SubscribeWithOptions(8, 7, &everyFourth));
+
+    // messages filtered out for every subscriber are reported as undelivered
+    for (uint8_t i = 0; i < 12; ++i) {
+        RPVC_Status_t st = publishByte(7, i);
+        assert(st == (i % 4 == 0 ? RPVC_OK : RPVC_ERR_OUT_OF_RANGE));
+    }
+    uint8_t value = 0;
+    for (uint8_t expected = 0; expected < 12; expected += 4) {
+        failOnError(RPVC_SB_Receive(8, &value, 1));
+        assert(value == expected);
+    }
+    assert(RPVC_SB_Receive(8, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_Unsubscribe(8, 7));
+    failOnError(RPVC_SB_Flush(8));
+
+#ifdef RPVC_OS_POSIX
+    RPVC_SbSubscribeOptions_t slow = {};
+    slow.minIntervalUs = 50000;
+    failOnError(RPVC_SB_SubscribeWithOptions(8, 8, &slow));
+    failOnError(publishByte(8, 1));
+    assert(publishByte(8, 2) == RPVC_ERR_OUT_OF_RANGE);
+    this_thread::sleep_for(chrono::milliseconds(60));
+    failOnError(publishByte(8, 3));
+    failOnError(RPVC_SB_Receive(8, &value, 1));
+    assert(value == 1);
+    failOnError(RPVC_SB_Receive(8, &value, 1));
+    assert(value == 3);
+    failOnError(RPVC_SB_Unsubscribe(8, 8));
+    failOnError(RPVC_SB_Flush(8));
+#endif
+
+    // options take a slot shared by every topic; a plain subscription takes none
+    RPVC_SbSubscribeOptions_t everyOther = {};
+    everyOther.decimation = 2;
+    for (uint32_t slot = 0; slot < RPVC_SB_MAX_FILTERS; slot++) {
+        failOnError(RPVC_SB_SubscribeWithOptions((RPVC_SbSubscriberId_t)(8 - slot / RPVC_SB_MAX_MESSAGE_ID),
+                                                 (RPVC_SbMsgId_t)(slot % RPVC_SB_MAX_MESSAGE_ID), &everyOther));
+    }
+    assert(RPVC_SB_SubscribeWithOptions(9, 0, &everyOther) == RPVC_ERR_NO_RESOURCE);
+    failOnError(RPVC_SB_Subscribe(9, 0));
+    // a slot let go is filled again by the next change
+    failOnError(RPVC_SB_Unsubscribe(8, 0));
+    failOnError(RPVC_SB_SubscribeWithOptions(9, 0, &everyOther));
+    failOnError(RPVC_SB_Unsubscribe(9, 0));
+    for (uint32_t slot = 1; slot < RPVC_SB_MAX_FILTERS; slot++) {
+        failOnError(RPVC_SB_Unsubscribe((RPVC_SbSubscriberId_t)(8 - slot / RPVC_SB_MAX_MESSAGE_ID), (RPVC_SbMsgId_t)(slot % RPVC_SB_MAX_MESSAGE_ID)));
+    }
+    failOnError(RPVC_SB_Flush(8));
+    failOnError(RPVC_SB_Flush(9));
+    cout << "Subscribe options test completed." << endl;
+}
+
+struct CallbackProbe {
+    int calls = 0;
+    uint8_t lastValue = 0;
+};
+
+static void onMessage(RPVC_SbMsgId_t messageId, const uint8_t *payload, size_t size, void *context)
+{
+    CallbackProbe *probe = static_cast<CallbackProbe*>(context);
+    assert(messageId == 9 && size == 1);
+    probe->calls++;
+    probe->lastValue = payload[0];
+}
+
+static void testCallbacks()
+{
+    CallbackProbe first, second;
+    assert(RPVC_SB_SubscribeCallback(9, nullptr, &first) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_SubscribeCallback(9, onMessage, &first));
+    failOnError(RPVC_SB_SubscribeCallback(9, onMessage, &second));
+    failOnError(RPVC_SB_SubscribeCallback(9, onMessage, &first)); // no duplicate
+
+    // push only: delivered without any pipe
+    failOnError(publishByte(9, 42));
+    assert(first.calls == 1 && first.lastValue == 42);
+    assert(second.calls == 1 && second.lastValue == 42);
+
+    // push and pull on the same ID
+    failOnError(RPVC_SB_Subscribe(0, 9));
+    failOnError(publishByte(9, 43));
+    uint8_t value = 0;
+    failOnError(RPVC_SB_Receive(0, &value, 1));
+    assert(value == 43 && first.calls == 2 && second.lastValue == 43);
+
+    failOnError(RPVC_SB_UnsubscribeCallback(9, onMessage, &first));
+    assert(RPVC_SB_UnsubscribeCallback(9, onMessage, &first) == RPVC_ERR_NOT_FOUND);
+    failOnError(publishByte(9, 44));
+    assert(first.calls == 2 && second.calls == 3);
+
+    // the slot let go is filled again
+    failOnError(RPVC_SB_SubscribeCallback(9, onMessage, &first));
+    failOnError(publishByte(9, 45));
+    assert(first.calls == 3 && first.lastValue == 45 && second.calls == 4);
+
+    failOnError(RPVC_SB_UnsubscribeCallback(9, onMessage, &first));
+    failOnError(RPVC_SB_UnsubscribeCallback(9, onMessage, &second));
+    failOnError(RPVC_SB_Unsubscribe(0, 9));
+    failOnError(RPVC_SB_Flush(0));
+    cout << "Callback test completed." << endl;
+}
+
+static void testStats()
+{
+    RPVC_SbStats_t before, after;
+    assert(RPVC_SB_GetStats(nullptr) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_GetStats(&before));
+
+    assert(publishByte(10, 0) == RPVC_ERR_OUT_OF_RANGE); // nobody subscribed yet
+    failOnError(RPVC_SB_Subscribe(2, 10));
+    for (uint8_t i = 0; i < RPVC_SB_MAX_QUEUE_DEPTH + 2; i++) {
+        (void)publishByte(10, i); // the last two find the pipe full
+    }
+    uint8_t value = 0;
+    failOnError(RPVC_SB_Receive(2, &value, 1));
+    failOnError(RPVC_SB_Receive(2, &value, 1));
+    failOnError(RPVC_SB_GetStats(&after));
+
+    const RPVC_SbTopicStats_t &t0 = before.topics[10], &t1 = after.topics[10];
+    assert(t1.published - t0.published == RPVC_SB_MAX_QUEUE_DEPTH + 3);
+    assert(t1.delivered - t0.delivered == RPVC_SB_MAX_QUEUE_DEPTH);
+    assert(t1.droppedFull - t0.droppedFull == 2);
+    assert(t1.noSubscribers - t0.noSubscribers == 1);
+
+    const RPVC_SbPipeStats_t &p0 = before.pipes[2], &p1 = after.pipes[2];
+    assert(p1.depth == RPVC_SB_MAX_QUEUE_DEPTH - 2);
+    assert(p1.peakDepth == RPVC_SB_MAX_QUEUE_DEPTH);
+    assert(p1.received - p0.received == 2);
+    assert(p1.dropped - p0.dropped == 2);
+
+    uint32_t timed = 0;
+    for (size_t i = 0; i < RPVC_SB_LATENCY_BUCKETS; i++) {
+        timed += after.latencyUs[i] - before.latencyUs[i];
+    }
+    assert(timed == (RPVC_SB_ENABLE_TIMESTAMPS ? 2U : 0U));
+
+    failOnError(RPVC_SB_Unsubscribe(2, 10));
+    failOnError(RPVC_SB_Flush(2));
+    cout << "Stats test completed." << endl;
+}
+
+#ifdef RPVC_OS_POSIX
+struct LatestSample {
+    uint32_t value;
+    uint32_t check; // always ~value; a torn read breaks the pair
+};
+
+static void hammerLatest(RPVC_SbMsgId_t msgId, uint32_t writes)
+{
+    for (uint32_t i = 1; i <= writes; i++) {
+        LatestSample sample = {i, ~i};
+        RPVC_SbMsgHandle_t mh = nullptr;
+        failOnError(RPVC_SB_CreateMessage(msgId, (const uint8_t*)&sample, sizeof(sample), &mh));
+        failOnError(RPVC_SB_Publish(mh));
+        failOnError(RPVC_SB_ReleaseMessage(mh));
+    }
+}
+#endif
+
+static void testLatest()
+{
+    uint8_t value = 0;
+    assert(RPVC_SB_ReadLatest(11, &value, 1, nullptr, nullptr) == RPVC_ERR_NOT_FOUND);
+    assert(RPVC_SB_CreateLatest(11, 0) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_CreateLatest(11, 8));
+    assert(RPVC_SB_CreateLatest(11, 8) == RPVC_ERR_STATE);
+    assert(RPVC_SB_ReadLatest(11, &value, 1, nullptr, nullptr) == RPVC_ERR_OUT_OF_RANGE);
+
+    // overwritten by every publish, not consumed by reads, no pipe needed
+    failOnError(publishByte(11, 1));
+    failOnError(publishByte(11, 2));
+    failOnError(publishByte(11, 3));
+    size_t size = 0;
+    uint32_t sequence = 0;
+    for (int i = 0; i < 2; i++) {
+        failOnError(RPVC_SB_ReadLatest(11, &value, 1, &size, &sequence));
+        assert(value == 3 && size == 1 && sequence == 3);
+    }
+
+    // longer payloads are truncated to the size given at creation
+    RPVC_SbMsgHandle_t mh = publishText(11, "0123456789");
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+    char text[16] = {0};
+    failOnError(RPVC_SB_ReadLatest(11, (uint8_t*)text, sizeof(text), &size, &sequence));
+    assert(size == 8 && memcmp(text, "01234567", 8) == 0 && sequence == 4);
+
+#ifdef RPVC_OS_POSIX
+    // readers never see a half-written value while a publisher runs flat out
+    failOnError(RPVC_SB_CreateLatest(12, sizeof(LatestSample)));
+    const uint32_t WRITES = 200000;
+    thread writer(hammerLatest, (RPVC_SbMsgId_t)12, WRITES);
+    LatestSample last = {0, ~0U};
+    while (last.value != WRITES) {
+        LatestSample sample;
+        if (RPVC_SB_ReadLatest(12, (uint8_t*)&sample, sizeof(sample), nullptr, nullptr) == RPVC_OK) {
+            assert(sample.check == ~sample.value && sample.value >= last.value);
+            last = sample;
+        }
+    }
+    writer.join();
+#endif
+    cout << "Latest value test completed." << endl;
+}
+
+#ifdef RPVC_OS_POSIX
+static void readBroadcastSequence(RPVC_SbMsgId_t msgId, uint8_t readerId, uint32_t count)
+{
+    for (uint32_t expected = 0; expected < count; ) {
+        uint32_t value = 0;
+        if (RPVC_SB_ReceiveBroadcast(msgId, readerId, (uint8_t*)&value, sizeof(value)) == RPVC_OK) {
+            assert(value == expected);
+            expected++;
+        }
+        else {
+            this_thread::yield();
+        }
+    }
+}
+#endif
+
+static void testBroadcast()
+{
+    const int READERS = 10;
+    RPVC_SbBroadcastConfig_t config = {6, nullptr};
+    assert(RPVC_SB_CreateBroadcast(13, &config) == RPVC_ERR_INVALID_ARG); // not a power of two
+    config.depth = 8;
+    failOnError(RPVC_SB_CreateBroadcast(13, &config));
+    assert(RPVC_SB_CreateBroadcast(13, &config) == RPVC_ERR_STATE);
+    assert(RPVC_SB_JoinBroadcast(14, 0) == RPVC_ERR_NOT_FOUND);
+
+    uint8_t value = 0;
+    assert(RPVC_SB_ReceiveBroadcast(13, 0, &value, 1) == RPVC_ERR_STATE);
+    assert(publishByte(13, 0) == RPVC_ERR_OUT_OF_RANGE); // no reader yet
+    for (uint8_t r = 0; r < READERS; r++) {
+        failOnError(RPVC_SB_JoinBroadcast(13, r));
+    }
+    assert(RPVC_SB_JoinBroadcast(13, 0) == RPVC_ERR_STATE);
+
+    // the ring fills once, whatever the number of readers
+    RPVC_SbStats_t before, after;
+    failOnError(RPVC_SB_GetStats(&before));
+    for (uint8_t i = 0; i < 8; i++) {
+        failOnError(publishByte(13, i));
+    }
+    assert(publishByte(13, 8) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_GetStats(&after));
+    assert(after.topics[13].delivered - before.topics[13].delivered == 8);
+    assert(after.topics[13].droppedFull - before.topics[13].droppedFull == 1);
+
+    for (uint8_t r = 0; r < READERS - 1; r++) {
+        for (uint8_t i = 0; i < 8; i++) {
+            failOnError(RPVC_SB_ReceiveBroadcast(13, r, &value, 1));
+            assert(value == i);
+        }
+        assert(RPVC_SB_ReceiveBroadcast(13, r, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+    }
+
+    // the slowest reader gates the publisher
+    RPVC_SbMsgHandle_t handles[4];
+    size_t count = 0;
+    failOnError(RPVC_SB_ReceiveBroadcastBatch(13, READERS - 1, handles, 4, &count));
+    assert(count == 4);
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *payload = nullptr;
+        size_t size = 0;
+        failOnError(RPVC_SB_GetMessagePayload(handles[i], &payload, &size));
+        assert(size == 1 && payload[0] == i);
+        failOnError(RPVC_SB_ReleaseMessage(handles[i]));
+    }
+    for (uint8_t i = 8; i < 12; i++) {
+        failOnError(publishByte(13, i));
+    }
+    assert(publishByte(13, 12) == RPVC_ERR_OUT_OF_RANGE);
+
+    // once it leaves, only the others count
+    failOnError(RPVC_SB_LeaveBroadcast(13, READERS - 1));
+    assert(RPVC_SB_LeaveBroadcast(13, READERS - 1) == RPVC_ERR_NOT_FOUND);
+    failOnError(publishByte(13, 12));
+    for (uint8_t i = 8; i <= 12; i++) {
+        failOnError(RPVC_SB_ReceiveBroadcast(13, 0, &value, 1));
+        assert(value == i);
+    }
+    for (uint8_t r = 0; r < READERS - 1; r++) {
+        failOnError(RPVC_SB_LeaveBroadcast(13, r));
+    }
+
+#ifdef RPVC_OS_POSIX
+    // a concurrent reader sees every message in order while the publisher backs off
+    config.depth = 16;
+    failOnError(RPVC_SB_CreateBroadcast(14, &config));
+    failOnError(RPVC_SB_JoinBroadcast(14, 3));
+    const uint32_t MESSAGES = 100000;
+    thread reader(readBroadcastSequence, (RPVC_SbMsgId_t)14, (uint8_t)3, MESSAGES);
+    for (uint32_t i = 0; i < MESSAGES; ) {
+        RPVC_SbMsgHandle_t mh = nullptr;
+        failOnError(RPVC_SB_CreateMessage(14, (const uint8_t*)&i, sizeof(i), &mh));
+        RPVC_Status_t st = RPVC_SB_Publish(mh);
+        failOnError(RPVC_SB_ReleaseMessage(mh));
+        if (st == RPVC_OK) {
+            i++;
+        }
+        else {
+            this_thread::yield(); // ring full: let the reader catch up
+        }
+    }
+    reader.join();
+    failOnError(RPVC_SB_LeaveBroadcast(14, 3));
+#endif
+    cout << "Broadcast test completed." << endl;
+}
+
+// Replies with every request byte doubled; an empty request is refused
+static RPVC_Status_t doubleBytes(RPVC_SbMsgId_t serviceId, const uint8_t *request, size_t requestSize,
+                                 uint8_t *reply, size_t replyCapacity, size_t *outReplySize, void *context)
+{
+    (void)serviceId;
+    (void)replyCapacity;
+    if (requestSize == 0) {
+        return RPVC_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < requestSize; i++) {
+        reply[i] = (uint8_t)(request[i] * 2);
+    }
+    *outReplySize = requestSize;
+    (*(uint32_t*)context)++;
+    return RPVC_OK;
+}
+
+// Pipe 3 serves message 15, pipe 8 takes the replies
+static void testRpc()
+{
+    uint32_t served = 0;
+    uint8_t request[3] = {1, 2, 3};
+    uint8_t reply[8] = {0};
+    size_t replySize = 0;
+    assert(RPVC_SB_Request(15, 8, request, sizeof(request), reply, sizeof(reply), &replySize, 0) == RPVC_ERR_NOT_READY);
+    const RPVC_SbPipeConfig_t replies = {RPVC_SB_MAX_QUEUE_DEPTH, RPVC_SB_OVERFLOW_DROP_NEWEST, nullptr};
+    failOnError(RPVC_SB_CreatePipe(8, &replies));
+    assert(RPVC_SB_Request(15, 8, request, sizeof(request), reply, sizeof(reply), &replySize, 0) == RPVC_ERR_OUT_OF_RANGE);
+    assert(RPVC_SB_Serve(3, doubleBytes, &served, 0) == RPVC_ERR_OUT_OF_RANGE);
+
+    // no server running: the request is queued and the caller gives up
+    failOnError(RPVC_SB_Subscribe(3, 15));
+    assert(RPVC_SB_Serve(3, nullptr, &served, 0) == RPVC_ERR_INVALID_ARG);
+    assert(RPVC_SB_Request(15, 8, request, sizeof(request), reply, sizeof(reply), &replySize, 0) == RPVC_ERR_TIMEOUT);
+    failOnError(RPVC_SB_Serve(3, doubleBytes, &served, 0));
+    assert(served == 1);
+
+#ifdef RPVC_OS_POSIX
+    // the late reply still sits in pipe 8; the next call must skip it
+    atomic<bool> stop(false);
+    thread server([&stop, &served]() {
+        while (!stop) {
+            RPVC_Status_t st = RPVC_SB_Serve(3, doubleBytes, &served, 10);
+            assert(st == RPVC_OK || st == RPVC_ERR_TIMEOUT);
+        }
+    });
+    for (uint8_t i = 0; i < 100; i++) {
+        request[0] = i;
+        failOnError(RPVC_SB_Request(15, 8, request, sizeof(request), reply, sizeof(reply), &replySize, 1000));
+        assert(replySize == 3 && reply[0] == (uint8_t)(i * 2) && reply[2] == 6);
+    }
+
+    // the handler's status comes back, and a small buffer only truncates
+    assert(RPVC_SB_Request(15, 8, nullptr, 0, reply, sizeof(reply), &replySize, 1000) == RPVC_ERR_INVALID_ARG);
+    assert(replySize == 0);
+    failOnError(RPVC_SB_Request(15, 8, request, sizeof(request), reply, 1, &replySize, 1000));
+    assert(replySize == 3 && reply[0] == 198);
+    stop = true;
+    server.join();
+    assert(served == 102);
+#else
+    uint8_t late[8] = {0};
+    failOnError(RPVC_SB_Receive(8, late, sizeof(late)));
+    assert(late[0] == 2 && late[2] == 6);
+#endif
+
+    assert(RPVC_SB_Serve(3, doubleBytes, &served, 0) == RPVC_ERR_TIMEOUT);
+    failOnError(RPVC_SB_Unsubscribe(3, 15));
+    failOnError(RPVC_SB_Flush(3));
+    failOnError(RPVC_SB_Flush(8));
+    cout << "RPC test completed." << endl;
+}
+
+// Pipe 9 takes message 16
+static void testDeadlines()
+{
+    assert(RPVC_SB_SetTopicTtl(16, RPVC_SB_MAX_TTL_US + 1) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_Subscribe(9, 16));
+
+    // the header is shared by queued copies, so it is frozen until they are gone
+    RPVC_SbMsgHandle_t mh = nullptr;
+    uint8_t value = 1;
+    failOnError(RPVC_SB_CreateMessage(16, &value, 1, &mh));
+    assert(RPVC_SB_SetMessageDeadline(mh, RPVC_SB_MAX_TTL_US + 1) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_Publish(mh));
+    assert(RPVC_SB_SetMessageDeadline(mh, 0) == RPVC_ERR_STATE);
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    failOnError(RPVC_SB_SetMessageDeadline(mh, 0));
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+
+#ifdef RPVC_OS_POSIX
+    RPVC_SbStats_t before, after;
+    failOnError(RPVC_SB_GetStats(&before));
+
+    // a consumer that fell behind gets the fresh value first
+    failOnError(RPVC_SB_SetTopicTtl(16, 20000));
+    for (uint8_t i = 0; i < 3; i++) {
+        failOnError(publishByte(16, i));
+    }
+    this_thread::sleep_for(chrono::milliseconds(30));
+    failOnError(publishByte(16, 3));
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 3);
+
+    // an explicit deadline outlives the topic default
+    failOnError(RPVC_SB_CreateMessage(16, &value, 1, &mh));
+    failOnError(RPVC_SB_SetMessageDeadline(mh, 1000000));
+    failOnError(RPVC_SB_Publish(mh));
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+    failOnError(publishByte(16, 4));
+    this_thread::sleep_for(chrono::milliseconds(30));
+    RPVC_SbMsgHandle_t handles[4];
+    size_t count = 0;
+    failOnError(RPVC_SB_ReceiveBatch(9, handles, 4, &count));
+    assert(count == 1 && handles[0] == mh);
+    failOnError(RPVC_SB_ReleaseMessage(handles[0]));
+
+    failOnError(publishByte(16, 5));
+    this_thread::sleep_for(chrono::milliseconds(30));
+    assert(RPVC_SB_ReceiveTimeout(9, &value, 1, 0) == RPVC_ERR_TIMEOUT);
+
+    failOnError(RPVC_SB_GetStats(&after));
+    assert(after.pipes[9].expired - before.pipes[9].expired == 5);
+    assert(after.topics[16].expired - before.topics[16].expired == 5);
+    assert(after.pipes[9].received - before.pipes[9].received == 2);
+    failOnError(RPVC_SB_SetTopicTtl(16, 0));
+#endif
+
+    failOnError(RPVC_SB_Unsubscribe(9, 16));
+    failOnError(RPVC_SB_Flush(9));
+    cout << "Deadline test completed." << endl;
+}
+
+// Pipe 9 takes message 17
+static void testPipeFd()
+{
+    int fd = -1;
+    assert(RPVC_SB_GetPipeFd(RPVC_SB_MAX_PIPES, &fd) == RPVC_ERR_INVALID_ARG);
+#if defined(RPVC_OS_POSIX) && defined(__linux__)
+    failOnError(RPVC_SB_Subscribe(9, 17));
+    failOnError(RPVC_SB_GetPipeFd(9, &fd));
+    int again = -1;
+    failOnError(RPVC_SB_GetPipeFd(9, &again));
+    assert(again == fd);
+
+    int epollFd = epoll_create1(0);
+    assert(epollFd >= 0);
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    assert(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0);
+    assert(epoll_wait(epollFd, &event, 1, 0) == 0);
+
+    // a burst is one write: the counter only moves on the empty -> non-empty edge
+    for (uint8_t i = 0; i < 3; i++) {
+        failOnError(publishByte(17, i));
+    }
+    assert(epoll_wait(epollFd, &event, 1, 0) == 1);
+    uint64_t edges = 0;
+    assert(read(fd, &edges, sizeof(edges)) == sizeof(edges) && edges == 1);
+    uint8_t value = 0;
+    while (RPVC_SB_Receive(9, &value, 1) == RPVC_OK) {
+    }
+    assert(value == 2 && epoll_wait(epollFd, &event, 1, 0) == 0);
+
+    thread publisher([]() {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        failOnError(publishByte(17, 42));
+    });
+    assert(epoll_wait(epollFd, &event, 1, 1000) == 1);
+    publisher.join();
+    assert(read(fd, &edges, sizeof(edges)) == sizeof(edges) && edges == 1);
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 42);
+
+    close(epollFd);
+    failOnError(RPVC_SB_Unsubscribe(9, 17));
+    failOnError(RPVC_SB_Flush(9));
+#else
+    assert(RPVC_SB_GetPipeFd(9, &fd) == RPVC_ERR_CONFIG);
+#endif
+    cout << "Pipe fd test completed." << endl;
+}
+
+#if RPVC_SB_MAX_SHARDS > 1 && defined(RPVC_OS_POSIX)
+static const uint32_t SHARD_MESSAGES = 2000;
+
+static void publishFromShard(uint8_t shard)
+{
+    failOnError(RPVC_SB_BindShard(shard));
+    for (uint32_t i = 0; i < SHARD_MESSAGES; ) {
+        uint32_t value = ((uint32_t)shard << 24) | i;
+        RPVC_SbMsgHandle_t mh = nullptr;
+        if (RPVC_SB_CreateMessage(18, (const uint8_t*)&value, sizeof(value), &mh) != RPVC_OK) {
+            this_thread::yield(); // pool empty until the owner catches up
+            continue;
+        }
+        RPVC_Status_t st = RPVC_SB_Publish(mh);
+        failOnError(RPVC_SB_ReleaseMessage(mh));
+        if (st == RPVC_OK) {
+            i++;
+        }
+        else {
+            this_thread::yield(); // mailbox full
+        }
+    }
+}
+#endif
+
+// Pipe 9 takes message 18 on another shard
+static void testShards()
+{
+    assert(RPVC_SB_BindShard(RPVC_SB_MAX_SHARDS) == RPVC_ERR_INVALID_ARG);
+    assert(RPVC_SB_SetPipeShard(9, RPVC_SB_MAX_SHARDS) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_BindShard(0));
+    failOnError(RPVC_SB_SetPipeShard(9, 0));
+
+#if RPVC_SB_MAX_SHARDS > 1
+    failOnError(RPVC_SB_Subscribe(9, 18));
+    failOnError(RPVC_SB_SetPipeShard(9, 1));
+
+    // copies wait in the mailbox until the owner receives
+    for (uint8_t i = 0; i < 3; i++) {
+        failOnError(publishByte(18, i));
+    }
+    RPVC_SbStats_t stats;
+    failOnError(RPVC_SB_GetStats(&stats));
+    assert(stats.pipes[9].depth == 0);
+    failOnError(RPVC_SB_BindShard(1));
+    uint8_t value = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        failOnError(RPVC_SB_Receive(9, &value, 1));
+        assert(value == i);
+    }
+    assert(RPVC_SB_Receive(9, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+
+    // a full mailbox drops at publish, a full pipe at drain time
+    failOnError(RPVC_SB_BindShard(0));
+    uint32_t droppedBefore = 0;
+    failOnError(RPVC_SB_GetPipeDropCount(9, &droppedBefore));
+    for (uint32_t i = 0; i < RPVC_SB_SHARD_MAILBOX_DEPTH; i++) {
+        failOnError(publishByte(18, (uint8_t)i));
+    }
+    assert(publishByte(18, 0) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_BindShard(1));
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 0);
+    uint32_t dropped = 0;
+    failOnError(RPVC_SB_GetPipeDropCount(9, &dropped));
+    assert(dropped - droppedBefore == 1 + RPVC_SB_SHARD_MAILBOX_DEPTH - RPVC_SB_MAX_QUEUE_DEPTH);
+    failOnError(RPVC_SB_Unsubscribe(9, 18));
+    failOnError(RPVC_SB_Flush(9));
+    failOnError(RPVC_SB_BindShard(0));
+
+#ifdef RPVC_OS_POSIX
+    // a post wakes the owner blocked on the pipe
+    failOnError(RPVC_SB_Subscribe(9, 18));
+    thread owner([]() {
+        failOnError(RPVC_SB_BindShard(1));
+        uint8_t received = 0;
+        failOnError(RPVC_SB_ReceiveTimeout(9, &received, 1, 1000));
+        assert(received == 7);
+    });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    failOnError(publishByte(18, 7));
+    owner.join();
+    failOnError(RPVC_SB_Unsubscribe(9, 18));
+    failOnError(RPVC_SB_Flush(9));
+
+    // every other shard publishes at once; the owner sees each one in order
+    const uint8_t OWNER = RPVC_SB_MAX_SHARDS - 1;
+    static RPVC_SbMsgHandle_t slots[256];
+    const RPVC_SbPipeConfig_t deep = {256, RPVC_SB_OVERFLOW_DROP_NEWEST, slots};
+    failOnError(RPVC_SB_CreatePipe(9, &deep));
+    failOnError(RPVC_SB_Subscribe(9, 18));
+    failOnError(RPVC_SB_SetPipeShard(9, OWNER));
+    vector<thread> publishers;
+    for (uint8_t shard = 0; shard < OWNER; shard++) {
+        publishers.emplace_back(publishFromShard, shard);
+    }
+    thread consumer([OWNER]() {
+        failOnError(RPVC_SB_BindShard(OWNER));
+        vector<uint32_t> next(OWNER, 0);
+        uint32_t total = 0;
+        while (total < (uint32_t)OWNER * SHARD_MESSAGES) {
+            RPVC_SbMsgHandle_t handles[256];
+            size_t count = 0;
+            if (RPVC_SB_ReceiveBatch(9, handles, 256, &count) != RPVC_OK) {
+                this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < count; i++) {
+                const uint8_t *payload = nullptr;
+                size_t size = 0;
+                failOnError(RPVC_SB_GetMessagePayload(handles[i], &payload, &size));
+                uint32_t received;
+                memcpy(&received, payload, sizeof(received));
+                uint32_t shard = received >> 24;
+                assert(shard < OWNER && (received & 0xFFFFFFU) == next[shard]);
+                next[shard]++;
+                failOnError(RPVC_SB_ReleaseMessage(handles[i]));
+            }
+            total += (uint32_t)count;
+        }
+    });
+    for (auto &publisher : publishers) {
+        publisher.join();
+    }
+    consumer.join();
+    failOnError(RPVC_SB_Unsubscribe(9, 18));
+    failOnError(RPVC_SB_Flush(9));
+#endif
+    failOnError(RPVC_SB_SetPipeShard(9, 0));
+#endif
+    cout << "Shard test completed." << endl;
+}
+
+static void countCredit(RPVC_SbMsgId_t messageId, void *context)
+{
+    assert(messageId == 19);
+    (*(uint32_t*)context)++;
+}
+
+#ifdef RPVC_OS_POSIX
+static atomic<uint32_t> g_creditPairs[2];
+
+static void creditPairA(RPVC_SbMsgId_t messageId, void *context)
+{
+    assert(messageId == 19 && context == &g_creditPairs[0]);
+    g_creditPairs[0]++;
+}
+
+static void creditPairB(RPVC_SbMsgId_t messageId, void *context)
+{
+    assert(messageId == 19 && context == &g_creditPairs[1]);
+    g_creditPairs[1]++;
+}
+#endif
+
+// Pipe 9 takes message 19 through a 4-slot queue
+static void testCredit()
+{
+    uint32_t credit = 0;
+    assert(RPVC_SB_GetCredit(RPVC_SB_MAX_MESSAGE_ID, &credit) == RPVC_ERR_INVALID_ARG);
+    assert(RPVC_SB_WaitCredit(19, 0, 0) == RPVC_ERR_INVALID_ARG);
+    failOnError(RPVC_SB_GetCredit(19, &credit));
+    assert(credit == UINT32_MAX);
+
+    const RPVC_SbPipeConfig_t shallow = {4, RPVC_SB_OVERFLOW_DROP_NEWEST, nullptr};
+    failOnError(RPVC_SB_CreatePipe(9, &shallow));
+    failOnError(RPVC_SB_Subscribe(9, 19));
+    uint32_t notified = 0;
+    failOnError(RPVC_SB_SetCreditCallback(19, countCredit, &notified));
+
+    // credit falls with every publish; a publisher that respects it never drops
+    for (uint8_t i = 0; i < 4; i++) {
+        failOnError(RPVC_SB_GetCredit(19, &credit));
+        assert(credit == 4U - i);
+        failOnError(publishByte(19, i));
+    }
+    failOnError(RPVC_SB_GetCredit(19, &credit));
+    assert(credit == 0);
+    assert(RPVC_SB_WaitCredit(19, 1, 0) == RPVC_ERR_TIMEOUT);
+
+    // the callback only fires after a publish found the pipe full
+    uint8_t value = 0;
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(notified == 0);
+    failOnError(publishByte(19, 4));
+    assert(publishByte(19, 5) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 1 && notified == 1);
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(notified == 1);
+    failOnError(RPVC_SB_WaitCredit(19, 2, 0));
+
+#ifdef RPVC_OS_POSIX
+    // a blocked publisher wakes when the consumer catches up
+    failOnError(publishByte(19, 6));
+    failOnError(publishByte(19, 7));
+    thread consumer([]() {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        uint8_t received = 0;
+        failOnError(RPVC_SB_Receive(9, &received, 1));
+    });
+    failOnError(RPVC_SB_WaitCredit(19, 1, 1000));
+    consumer.join();
+    assert(RPVC_SB_WaitCredit(19, 4, 10) == RPVC_ERR_TIMEOUT);
+
+    // a waiter short of more than one slot sleeps through the partial receives
+    thread drainer([]() {
+        for (int i = 0; i < 3; i++) {
+            this_thread::sleep_for(chrono::milliseconds(5));
+            uint8_t received = 0;
+            failOnError(RPVC_SB_Receive(9, &received, 1));
+        }
+    });
+    failOnError(RPVC_SB_WaitCredit(19, 4, 1000));
+    drainer.join();
+
+    // a callback is never called with the context of the one it replaced
+    failOnError(RPVC_SB_SetCreditCallback(19, creditPairA, &g_creditPairs[0]));
+    atomic<bool> stop(false);
+    thread setter([&stop]() {
+        while (!stop) {
+            failOnError(RPVC_SB_SetCreditCallback(19, creditPairA, &g_creditPairs[0]));
+            failOnError(RPVC_SB_SetCreditCallback(19, creditPairB, &g_creditPairs[1]));
+        }
+    });
+    for (int i = 0; i < 2000; i++) {
+        while (publishByte(19, 0) == RPVC_OK) {
+        }
+        uint8_t received = 0;
+        failOnError(RPVC_SB_Receive(9, &received, 1));
+    }
+    stop = true;
+    setter.join();
+    assert(g_creditPairs[0] + g_creditPairs[1] == 2000);
+#endif
+
+    failOnError(RPVC_SB_SetCreditCallback(19, nullptr, nullptr));
+    failOnError(RPVC_SB_Unsubscribe(9, 19));
+    failOnError(RPVC_SB_Flush(9));
+    cout << "Credit test completed." << endl;
+}
+
+static void subscribeToLatch(RPVC_SbMsgId_t messageId, const uint8_t *payload, size_t size, void *context)
+{
+    (void)messageId;
+    (void)payload;
+    (void)size;
+    (void)context;
+    failOnError(RPVC_SB_Subscribe(9, 17));
+}
+
+// Pipe 9 joins message 17 again after it was published
+static void testLatch()
+{
+    uint8_t value = 0;
+    assert(RPVC_SB_SetTopicLatch(RPVC_SB_MAX_MESSAGE_ID, true) == RPVC_ERR_INVALID_ARG);
+    assert(publishByte(17, 1) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_SetTopicLatch(17, true));
+    failOnError(publishByte(17, 1));
+    failOnError(publishByte(17, 2));
+
+    // a late subscriber starts from the last value, once
+    failOnError(RPVC_SB_Subscribe(9, 17));
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 2);
+    failOnError(RPVC_SB_Subscribe(9, 17));
+    assert(RPVC_SB_Receive(9, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+
+    failOnError(publishByte(17, 3));
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 3);
+    failOnError(RPVC_SB_Unsubscribe(9, 17));
+    failOnError(RPVC_SB_Subscribe(9, 17));
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 3);
+
+    // the hand-off stays ahead of what is published after subscribing
+    failOnError(RPVC_SB_Unsubscribe(9, 17));
+    failOnError(RPVC_SB_Subscribe(9, 17));
+    failOnError(publishByte(17, 4));
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 3);
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 4);
+
+    // a batch handler that subscribes: the hand-off lands behind the copies
+    // staged before it, never on top of them
+    failOnError(RPVC_SB_Unsubscribe(9, 17));
+    failOnError(RPVC_SB_Subscribe(9, 16));
+    failOnError(RPVC_SB_SubscribeCallback(18, subscribeToLatch, nullptr));
+    const RPVC_SbMsgId_t ids[4] = {16, 18, 16, 17};
+    RPVC_SbMsgHandle_t batch[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t payload = (uint8_t)(10 + i);
+        failOnError(RPVC_SB_CreateMessage(ids[i], &payload, 1, &batch[i]));
+    }
+#if RPVC_SB_PRIORITY_LANES > 1
+    failOnError(RPVC_SB_SetMessagePriority(batch[2], 1));
+    const uint8_t expected[4] = {12, 10, 4, 13};
+#else
+    const uint8_t expected[4] = {10, 4, 12, 13};
+#endif
+    failOnError(RPVC_SB_PublishBatch(batch, 4));
+    RPVC_SbStats_t stats;
+    failOnError(RPVC_SB_GetStats(&stats));
+    assert(stats.pipes[9].depth == 4);
+    for (uint8_t i = 0; i < 4; i++) {
+        failOnError(RPVC_SB_Receive(9, &value, 1));
+        assert(value == expected[i]);
+        failOnError(RPVC_SB_ReleaseMessage(batch[i]));
+    }
+    assert(RPVC_SB_Receive(9, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_UnsubscribeCallback(18, subscribeToLatch, nullptr));
+    failOnError(RPVC_SB_Unsubscribe(9, 16));
+
+    failOnError(RPVC_SB_SetTopicLatch(17, false));
+    failOnError(RPVC_SB_Unsubscribe(9, 17));
+    failOnError(RPVC_SB_Subscribe(9, 17));
+    assert(RPVC_SB_Receive(9, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+
+    failOnError(RPVC_SB_Unsubscribe(9, 17));
+    failOnError(RPVC_SB_Flush(9));
+    cout << "Latch test completed." << endl;
+}
+
+#ifdef RPVC_OS_POSIX
+static atomic<uint32_t> g_routeCallbacks(0);
+
+static void countRouteCallback(RPVC_SbMsgId_t messageId, const uint8_t *payload, size_t size, void *context)
+{
+    (void)payload;
+    assert(messageId == 17 && size == 1 && context == &g_routeCallbacks);
+    g_routeCallbacks++;
+}
+#endif
+
+// Pipe 9 toggles its subscription to message 17 while another thread
+// publishes it, latched, so every join also takes a reference to the latch;
+// then handlers and filters change under the publisher
+static void testRouteChanges()
+{
+#ifdef RPVC_OS_POSIX
+    failOnError(RPVC_SB_SetTopicLatch(17, true));
+    atomic<bool> stop(false);
+    thread publisher([&stop]() {
+        uint8_t value = 0;
+        while (!stop) {
+            RPVC_Status_t st = publishByte(17, value++);
+            assert(st == RPVC_OK || st == RPVC_ERR_OUT_OF_RANGE);
+            this_thread::yield();
+        }
+    });
+
+    uint8_t value = 0;
+    for (int i = 0; i < 1000; i++) {
+        failOnError(RPVC_SB_Subscribe(9, 17));
+        // values only move forward, the latched one included
+        bool first = true;
+        uint8_t last = 0;
+        while (RPVC_SB_Receive(9, &value, 1) == RPVC_OK) {
+            assert(first || (uint8_t)(value - last) < 128);
+            first = false;
+            last = value;
+        }
+        failOnError(RPVC_SB_Unsubscribe(9, 17));
+    }
+    failOnError(RPVC_SB_SetTopicLatch(17, false));
+
+    const RPVC_SbContentMatch_t odd = {0, 1, RPVC_SB_MATCH_ANY_BITS, 1};
+    RPVC_SbSubscribeOptions_t oddOnly = {};
+    oddOnly.decimation = 2;
+    oddOnly.matches = &odd;
+    oddOnly.matchCount = 1;
+    for (int i = 0; i < 1000; i++) {
+        failOnError(RPVC_SB_SubscribeCallback(17, countRouteCallback, &g_routeCallbacks));
+        failOnError(RPVC_SB_SubscribeWithOptions(9, 17, (i & 1) != 0 ? &oddOnly : nullptr));
+        while (RPVC_SB_Receive(9, &value, 1) == RPVC_OK) {
+        }
+        failOnError(RPVC_SB_UnsubscribeCallback(17, countRouteCallback, &g_routeCallbacks));
+        failOnError(RPVC_SB_Unsubscribe(9, 17));
+    }
+    stop = true;
+    publisher.join();
+    failOnError(RPVC_SB_Flush(9));
+#endif
+    cout << "Route change test completed." << endl;
+}
+
+// Pipe 9 takes message 16 again, now in two lanes
+static void testPriority()
+{
+    assert(RPVC_SB_SetTopicPriority(16, RPVC_SB_PRIORITY_LANES) == RPVC_ERR_INVALID_ARG);
+#if RPVC_SB_PRIORITY_LANES > 1
+    failOnError(RPVC_SB_Subscribe(9, 16));
+    for (uint8_t i = 1; i <= 3; i++) {
+        failOnError(publishByte(16, i));
+    }
+
+    // a command overtakes the telemetry already queued
+    RPVC_SbMsgHandle_t mh = nullptr;
+    uint8_t value = 100;
+    failOnError(RPVC_SB_CreateMessage(16, &value, 1, &mh));
+    failOnError(RPVC_SB_SetMessagePriority(mh, 1));
+    failOnError(RPVC_SB_Publish(mh));
+    assert(RPVC_SB_SetMessagePriority(mh, 0) == RPVC_ERR_STATE);
+    RPVC_SbStats_t stats;
+    failOnError(RPVC_SB_GetStats(&stats));
+    assert(stats.pipes[9].depth == 4);
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 100);
+    for (uint8_t i = 1; i <= 3; i++) {
+        failOnError(RPVC_SB_Receive(9, &value, 1));
+        assert(value == i);
+    }
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+
+    // the topic default applies to messages without their own, in batches too
+    failOnError(RPVC_SB_SetTopicPriority(16, 1));
+    RPVC_SbMsgHandle_t batch[2];
+    uint8_t values[2] = {8, 9};
+    for (int i = 0; i < 2; i++) {
+        failOnError(RPVC_SB_CreateMessage(16, &values[i], 1, &batch[i]));
+    }
+    failOnError(RPVC_SB_SetMessagePriority(batch[0], RPVC_SB_PRIORITY_NORMAL));
+    failOnError(RPVC_SB_PublishBatch(batch, 2));
+    RPVC_SbMsgHandle_t handles[4];
+    size_t count = 0;
+    failOnError(RPVC_SB_ReceiveBatch(9, handles, 4, &count));
+    assert(count == 2 && handles[0] == batch[1] && handles[1] == batch[0]);
+    for (int i = 0; i < 2; i++) {
+        failOnError(RPVC_SB_ReleaseMessage(handles[i]));
+        failOnError(RPVC_SB_ReleaseMessage(batch[i]));
+    }
+
+    // each lane overflows on its own
+    for (uint8_t i = 0; i < RPVC_SB_PRIORITY_LANE_DEPTH; i++) {
+        failOnError(publishByte(16, i));
+    }
+    assert(publishByte(16, 0) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(RPVC_SB_SetTopicPriority(16, RPVC_SB_PRIORITY_NORMAL));
+    failOnError(publishByte(16, 50));
+    for (uint8_t i = 0; i < RPVC_SB_PRIORITY_LANE_DEPTH; i++) {
+        failOnError(RPVC_SB_Receive(9, &value, 1));
+        assert(value == i);
+    }
+    failOnError(RPVC_SB_Receive(9, &value, 1));
+    assert(value == 50);
+    assert(RPVC_SB_Receive(9, &value, 1) == RPVC_ERR_OUT_OF_RANGE);
+
+    failOnError(RPVC_SB_Unsubscribe(9, 16));
+    failOnError(RPVC_SB_Flush(9));
+#endif
+    cout << "Priority test completed." << endl;
+}
+
+// Messages over half a cache line start on one; the memory pool takes the
+// overflow and the smaller messages. Broadcast rings from earlier tests
+// still hold some blocks.
+static void testMessageSlab()
+{
+    vector<RPVC_SbMsgHandle_t> handles;
+    uint8_t payload[RPVC_SB_MAX_PAYLOAD_SIZE] = {0};
+    for (int i = 0; i < RPVC_SB_MESSAGE_SLAB_SLOTS + 8; i++) {
+        RPVC_SbMsgHandle_t mh = nullptr;
+        failOnError(RPVC_SB_CreateMessage(1, payload, 64, &mh));
+        handles.push_back(mh);
+    }
+#if RPVC_SB_MESSAGE_SLAB_SLOTS > 0
+    assert((uintptr_t)handles[0] % 64 == 0);
+#endif
+    RPVC_SbMsgHandle_t large = nullptr;
+    failOnError(RPVC_SB_CreateMessage(1, payload, sizeof(payload), &large));
+    handles.push_back(large);
+    for (auto mh : handles) {
+        failOnError(RPVC_SB_ReleaseMessage(mh));
+    }
+
+    // freed slots are reused, and not by a message a small pool class fits
+    RPVC_SbMsgHandle_t heartbeat = nullptr;
+    failOnError(RPVC_SB_CreateMessage(1, payload, 8, &heartbeat));
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(1, payload, 64, &mh));
+#if RPVC_SB_MESSAGE_SLAB_SLOTS > 0
+    assert(mh == handles[0]);
+#endif
+    failOnError(RPVC_SB_ReleaseMessage(heartbeat));
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+    cout << "Message slab test completed." << endl;
+}
+
+struct SensorReading {
+    uint8_t sensor;
+    uint8_t flags;
+    uint16_t severity;
+};
+
+static RPVC_Status_t publishReading(uint8_t sensor, uint16_t severity)
+{
+    SensorReading reading = {sensor, 0, severity};
+    RPVC_SbMsgHandle_t mh = nullptr;
+    failOnError(RPVC_SB_CreateMessage(16, (const uint8_t*)&reading, sizeof(reading), &mh));
+    RPVC_Status_t st = RPVC_SB_Publish(mh);
+    failOnError(RPVC_SB_ReleaseMessage(mh));
+    return st;
+}
+
+static void testContentFilter()
+{
+    RPVC_SbContentMatch_t badWidth = {0, 3, RPVC_SB_MATCH_EQ, 1};
+    RPVC_SbSubscribeOptions_t bad = {0, 0, &badWidth, 1};
+    assert(RPVC_SB_SubscribeWithOptions(9, 16, &bad) == RPVC_ERR_INVALID_ARG);
+    RPVC_SbContentMatch_t pastEnd = {RPVC_SB_MAX_PAYLOAD_SIZE, 1, RPVC_SB_MATCH_EQ, 1};
+    bad.matches = &pastEnd;
+    assert(RPVC_SB_SubscribeWithOptions(9, 16, &bad) == RPVC_ERR_INVALID_ARG);
+    RPVC_SbContentMatch_t tooWide = {0, 1, RPVC_SB_MATCH_EQ, 256};
+    bad.matches = &tooWide;
+    assert(RPVC_SB_SubscribeWithOptions(9, 16, &bad) == RPVC_ERR_INVALID_ARG);
+    bad.matches = nullptr;
+    assert(RPVC_SB_SubscribeWithOptions(9, 16, &bad) == RPVC_ERR_INVALID_ARG);
+
+    // sensor 2 at severity 10 and up; the rest never reach the pipe
+    const RPVC_SbContentMatch_t alarms[2] = {
+        {offsetof(SensorReading, sensor), 1, RPVC_SB_MATCH_EQ, 2},
+        {offsetof(SensorReading, severity), 2, RPVC_SB_MATCH_GE, 10},
+    };
+    RPVC_SbSubscribeOptions_t options = {0, 0, alarms, 2};
+    failOnError(RPVC_SB_SubscribeWithOptions(9, 16, &options));
+    assert(publishReading(1, 50) == RPVC_ERR_OUT_OF_RANGE);
+    assert(publishReading(2, 9) == RPVC_ERR_OUT_OF_RANGE);
+    failOnError(publishReading(2, 10));
+    failOnError(publishReading(2, 700));
+    assert(publishByte(16, 2) == RPVC_ERR_OUT_OF_RANGE); // too short to hold severity
+
+    SensorReading reading;
+    failOnError(RPVC_SB_Receive(9, (uint8_t*)&reading, sizeof(reading)));
+    assert(reading.sensor == 2 && reading.severity == 10);
+    failOnError(RPVC_SB_Receive(9, (uint8_t*)&reading, sizeof(reading)));
+    assert(reading.severity == 700);
+    assert(RPVC_SB_Receive(9, (uint8_t*)&reading, sizeof(reading)) == RPVC_ERR_OUT_OF_RANGE);
+
+    // decimation counts matching messages only
+    const RPVC_SbContentMatch_t notSensor1 = {offsetof(SensorReading, sensor), 1, RPVC_SB_MATCH_NE, 1};
+    RPVC_SbSubscribeOptions_t everyOther = {2, 0, &notSensor1, 1};
+    failOnError(RPVC_SB_SubscribeWithOptions(9, 16, &everyOther));
+    for (uint16_t i = 0; i < 4; i++) {
+        publishReading(1, i);
+        publishReading(3, i);
+    }
+    for (uint16_t expected = 0; expected < 4; expected += 2) {
+        failOnError(RPVC_SB_Receive(9, (uint8_t*)&reading, sizeof(reading)));
+        assert(reading.sensor == 3 && reading.severity == expected);
+    }
+    assert(RPVC_SB_Receive(9, (uint8_t*)&reading, sizeof(reading)) == RPVC_ERR_OUT_OF_RANGE);
+
+    failOnError(RPVC_SB_Unsubscribe(9, 16));
+    failOnError(RPVC_SB_Flush(9));
+    cout << "Content filter test completed." << endl;
+}
+
+// Messages still queued at RPVC_SB_Deinit go back to the pool: the rounds
+// leave more of the largest blocks queued than the pool has
+static void testDeinitReleasesQueued()
+{
+    const RPVC_SoftwareBusConfig_t sbConfig = {};
+    const RPVC_SbPipeConfig_t pooled = {4, RPVC_SB_OVERFLOW_DROP_NEWEST, nullptr};
+    uint8_t payload[RPVC_SB_MAX_PAYLOAD_SIZE] = {0};
+    for (int round = 0; round < 20; round++) {
+        failOnError(RPVC_SB_Init(&sbConfig));
+        failOnError(RPVC_SB_CreatePipe(0, &pooled));
+        failOnError(RPVC_SB_Subscribe(0, 1));
+        failOnError(RPVC_SB_Subscribe(1, 1));
+        for (int i = 0; i < 2; i++) {
+            RPVC_SbMsgHandle_t mh = nullptr;
+            failOnError(RPVC_SB_CreateMessage(1, payload, sizeof(payload), &mh));
+            failOnError(RPVC_SB_Publish(mh));
+            failOnError(RPVC_SB_ReleaseMessage(mh));
+        }
+        failOnError(RPVC_SB_Deinit());
+    }
+    cout << "Deinit test completed." << endl;
+}
+
 int main() 
 {
     const RPVC_SoftwareBusConfig_t sbConfig = {};
@@ -116,7 +1426,29 @@ int main()
             }
         }
     }
+    testReceiveTimeout();
+    testBatch();
+    testLoan();
+    testVariableSize();
+    testPipePolicies();
+    testSubscribeOptions();
+    testCallbacks();
+    testStats();
+    testLatest();
+    testBroadcast();
+    testRpc();
+    testDeadlines();
+    testPipeFd();
+    testShards();
+    testCredit();
+    testLatch();
+    testRouteChanges();
+    testPriority();
+    testMessageSlab();
+    testContentFilter();
+
     failOnError(RPVC_SB_Deinit());
+    testDeinitReleasesQueued();
     cout << "Stress test completed." << endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "RPVC_MEMORYPOOL.h"
+#include "SoftwareBusTopic.hpp"
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+#include <iostream>
+using namespace std;
+
+#define failOnError(status) \
+    do { \
+        if ((status) != RPVC_OK) { \
+            cout << "Error: " << (int)(status) << " at " << __FILE__ << ":" << __LINE__ << endl; \
+            abort(); \
+        } \
+    } while (0)
+
+struct Attitude {
+    double roll;
+    double pitch;
+    double yaw;
+    uint32_t sequence;
+};
+
+using AttitudeTopic = RPVC::Topic<4, Attitude>;
+using CounterTopic = RPVC::Topic<5, uint32_t>;
+
+static_assert(AttitudeTopic::Id == 4 && AttitudeTopic::Size == sizeof(Attitude), "topic traits");
+
+int main()
+{
+    const RPVC_SoftwareBusConfig_t sbConfig = {};
+    failOnError(RPVC_MEMORYPOOL_Init());
+    failOnError(RPVC_SB_Init(&sbConfig));
+    failOnError(AttitudeTopic::Subscribe(0));
+    failOnError(CounterTopic::Subscribe(1));
+
+    // zero-copy round trip: the sample points into the queued message
+    failOnError(AttitudeTopic::Publish(Attitude{0.1, 0.2, 0.3, 7}));
+    failOnError(AttitudeTopic::PublishInPlace([](Attitude &a) { a.yaw = 1.5; a.sequence = 8; }));
+    {
+        RPVC::Sample<Attitude> first;
+        assert(!first.IsValid());
+        failOnError(AttitudeTopic::Receive(0, first));
+        assert(first->sequence == 7 && first->pitch == 0.2);
+
+        RPVC::Sample<Attitude> second;
+        failOnError(AttitudeTopic::Receive(0, second));
+        assert(second->roll == 0.0 && second->yaw == 1.5 && (*second).sequence == 8);
+
+        first = std::move(second); // releases the first message
+        assert(!second.IsValid() && first.Get().sequence == 8);
+    }
+    RPVC::Sample<Attitude> none;
+    assert(AttitudeTopic::Receive(0, none) == RPVC_ERR_OUT_OF_RANGE && !none.IsValid());
+
+    // copying receive
+    failOnError(CounterTopic::Publish(41));
+    uint32_t counter = 0;
+    failOnError(CounterTopic::Receive(1, counter));
+    assert(counter == 41);
+
+    // a pipe shared with another topic is reported, not misread
+    failOnError(CounterTopic::Subscribe(0));
+    failOnError(CounterTopic::Publish(42));
+    RPVC::Sample<Attitude> wrong;
+    assert(AttitudeTopic::Receive(0, wrong) == RPVC_ERR_INTEGRITY && !wrong.IsValid());
+    failOnError(CounterTopic::Publish(43));
+    Attitude untouched = {1.0, 2.0, 3.0, 9};
+    assert(AttitudeTopic::Receive(0, untouched) == RPVC_ERR_INTEGRITY && untouched.sequence == 9);
+    failOnError(CounterTopic::Unsubscribe(0));
+
+    // a fill that throws hands its loan back; leaked loans would exhaust the pool
+    for (int i = 0; i < 1000; i++) {
+        try {
+            (void)AttitudeTopic::PublishInPlace([](Attitude &) { throw std::runtime_error("sensor fault"); });
+            assert(false);
+        }
+        catch (const std::runtime_error &) {
+        }
+    }
+    failOnError(AttitudeTopic::Publish(Attitude{}));
+    failOnError(AttitudeTopic::Receive(0, untouched));
+    assert(untouched.sequence == 0);
+
+    failOnError(AttitudeTopic::Unsubscribe(0));
+    failOnError(CounterTopic::Unsubscribe(1));
+    failOnError(RPVC_SB_Deinit());
+    failOnError(RPVC_MEMORYPOOL_Deinit());
+    cout << "Topic test completed." << endl;
+    return 0;
+}